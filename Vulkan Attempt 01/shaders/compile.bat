@@ -1,5 +1,7 @@
 @echo off
-SET glsl="E:\C Libs\VulkanSDK\1.0.65.1\Bin\glslangValidator.exe"
+SET glsl="%VULKAN_SDK%\Bin\glslangValidator.exe"
 %glsl% -V shader.vert
 %glsl% -V shader.frag
+%glsl% -V cull.comp -o cull.spv
+%glsl% -V compact.comp -o compact.spv
 pause
\ No newline at end of file
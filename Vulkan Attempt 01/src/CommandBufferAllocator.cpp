@@ -0,0 +1,93 @@
+#include "CommandBufferAllocator.hpp"
+
+#include <stdexcept>
+
+using namespace com::gelunox::vulcanUtils;
+using namespace std;
+
+CommandBufferAllocator::CommandBufferAllocator( VkDevice device, uint32_t queueFamily, uint32_t frameCount, VkCommandBufferLevel level )
+	: device( device ), level( level )
+{
+	VkCommandPoolCreateInfo poolInfo = {};
+	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.queueFamilyIndex = queueFamily;
+	//buffers live for a single frame, and are only ever reset through their pool
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+	frames.resize( frameCount );
+
+	for (FramePool& frame : frames)
+	{
+		if (vkCreateCommandPool( device, &poolInfo, nullptr, &frame.pool ) != VK_SUCCESS)
+		{
+			throw runtime_error( "frame commandpool creation failed" );
+		}
+	}
+}
+
+CommandBufferAllocator::~CommandBufferAllocator()
+{
+	//destroying a pool frees its buffers
+	for (FramePool& frame : frames)
+	{
+		vkDestroyCommandPool( device, frame.pool, nullptr );
+	}
+}
+
+void CommandBufferAllocator::beginFrame( uint32_t frameIndex )
+{
+	current = &frames[frameIndex];
+
+	//keep the memory, the same frame will need about as much of it again
+	vkResetCommandPool( device, current->pool, 0 );
+	current->used = 0;
+
+	lastFrameStats = frameStats;
+	frameStats = CommandBufferStats();
+}
+
+VkCommandBuffer CommandBufferAllocator::allocate()
+{
+	if (current == nullptr)
+	{
+		throw logic_error( "allocate called before beginFrame" );
+	}
+
+	if (current->used < current->buffers.size())
+	{
+		frameStats.reused++;
+		totalStats.reused++;
+
+		return current->buffers[current->used++];
+	}
+
+	VkCommandBufferAllocateInfo allocInfo = {};
+	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocInfo.commandPool = current->pool;
+	allocInfo.level = level;
+	allocInfo.commandBufferCount = 1;
+
+	VkCommandBuffer cmdBuffer;
+	if (vkAllocateCommandBuffers( device, &allocInfo, &cmdBuffer ) != VK_SUCCESS)
+	{
+		throw runtime_error( "command buffer allocation failed" );
+	}
+
+	frameStats.allocated++;
+	totalStats.allocated++;
+
+	current->buffers.push_back( cmdBuffer );
+	current->used++;
+
+	return cmdBuffer;
+}
+
+void CommandBufferStats::report( ostream& out, const char * name, const CommandBufferStats * lastFrame ) const
+{
+	out << name << " command buffers";
+	if (lastFrame)
+	{
+		out << " | last frame: " << lastFrame->allocated << " allocated, " << lastFrame->reused << " reused";
+	}
+	out << " | total: " << allocated << " allocated, " << reused << " reused" << endl;
+}
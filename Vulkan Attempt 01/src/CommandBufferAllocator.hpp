@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <ostream>
+
+using namespace std;
+
+namespace com::gelunox::vulcanUtils
+{
+	struct CommandBufferStats
+	{
+		uint64_t allocated = 0;
+		uint64_t reused = 0;
+
+		void add( const CommandBufferStats& other ) { allocated += other.allocated; reused += other.reused; }
+		//one line for every source of command buffers, a steady frame allocates nothing and only reuses
+		void report( ostream& out, const char * name, const CommandBufferStats * lastFrame = nullptr ) const;
+	};
+
+	//a command pool per frame in flight, reset as a whole with one vkResetCommandPool when the frame comes around again
+	//buffers are never freed, a reset pool hands its previous buffers out again before allocating new ones
+	class CommandBufferAllocator
+	{
+	private:
+		struct FramePool
+		{
+			VkCommandPool pool;
+			vector<VkCommandBuffer> buffers;
+			//buffers handed out since the last reset
+			size_t used = 0;
+		};
+
+		VkDevice device;
+		VkCommandBufferLevel level;
+
+		vector<FramePool> frames;
+		FramePool * current = nullptr;
+
+		CommandBufferStats frameStats;
+		CommandBufferStats lastFrameStats;
+		CommandBufferStats totalStats;
+
+	public:
+		CommandBufferAllocator( VkDevice device, uint32_t queueFamily, uint32_t frameCount,
+			VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY );
+		~CommandBufferAllocator();
+
+		//only call once the fence of frameIndex has signaled, every buffer from its previous use becomes invalid
+		void beginFrame( uint32_t frameIndex );
+		//the buffer is reset and only valid until the next beginFrame of the same slot
+		VkCommandBuffer allocate();
+
+		//counts of the frame before the current one, the current frame may still allocate
+		const CommandBufferStats& getLastFrameStats() { return lastFrameStats; }
+		const CommandBufferStats& getTotalStats() { return totalStats; }
+	};
+}
@@ -0,0 +1,289 @@
+#include "CullingPass.hpp"
+
+#include "util/Util.hpp"
+#include "builder/ComputePipelineBuilder.hpp"
+#include "builder/PipelineLayoutBuilder.hpp"
+#include "builder/DescriptorSetLayoutBuilder.hpp"
+#include "builder/DescriptorPoolBuilder.hpp"
+
+#include <stdexcept>
+#include <algorithm>
+
+using namespace com::gelunox::vulcanUtils;
+using namespace std;
+
+static const uint32_t WORKGROUP_SIZE = 64;
+
+CullingPass::CullingPass( VkPhysicalDevice physicalDevice, VkDevice device, MemoryAllocator * allocator, MemoryFactory& memFac, AssetLoader& assets, VkPipelineCache pipelineCache,
+	uint32_t framesInFlight, uint32_t maxObjects, uint32_t maxBatches, bool useDrawIndirectCount )
+	: device( device ), memFac( memFac ), framesInFlight( framesInFlight ), maxObjects( maxObjects ), maxBatches( maxBatches )
+{
+	if (useDrawIndirectCount)
+	{
+		drawIndirectCount = (PFN_vkCmdDrawIndexedIndirectCountKHR)vkGetDeviceProcAddr( device, "vkCmdDrawIndexedIndirectCountKHR" );
+	}
+
+	VkPhysicalDeviceProperties deviceProps;
+	vkGetPhysicalDeviceProperties( physicalDevice, &deviceProps );
+	storageAlignment = deviceProps.limits.minStorageBufferOffsetAlignment;
+
+	params = new FrameUniformBuffer( physicalDevice, device, allocator, sizeof( CullParams ), framesInFlight );
+	objects = new FrameUniformBuffer( physicalDevice, device, allocator, sizeof( CullObject ) * maxObjects, framesInFlight,
+		VK_BUFFER_USAGE_STORAGE_BUFFER_BIT );
+	batches = new FrameUniformBuffer( physicalDevice, device, allocator, sizeof( VkDrawIndexedIndirectCommand ) * maxBatches, framesInFlight,
+		VK_BUFFER_USAGE_STORAGE_BUFFER_BIT );
+
+	//counters are cleared with vkCmdFillBuffer every frame
+	createDeviceBuffer( sizeof( uint32_t ) * maxBatches, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, counts, countsMemory );
+	createDeviceBuffer( sizeof( glm::mat4 ) * maxObjects, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, visible, visibleMemory );
+	createDeviceBuffer( sizeof( VkDrawIndexedIndirectCommand ) * maxBatches, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+		commands, commandsMemory );
+	createDeviceBuffer( sizeof( uint32_t ), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		drawCount, drawCountMemory );
+
+	descriptorLayout = DescriptorSetLayoutBuilder( device )
+		.addBinding( 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr )
+		.addBinding( 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr )
+		.addBinding( 2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr )
+		.addBinding( 3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr )
+		.addBinding( 4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr )
+		.addBinding( 5, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr )
+		.addBinding( 6, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr )
+		.build();
+
+	descriptorPool = DescriptorPoolBuilder( device )
+		.addPoolSize( VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, framesInFlight )
+		.addPoolSize( VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 6 * framesInFlight )
+		.setMaxSets( framesInFlight )
+		.build();
+
+	vector<VkDescriptorSetLayout> layouts( framesInFlight, descriptorLayout );
+	descriptorSets.resize( framesInFlight );
+
+	VkDescriptorSetAllocateInfo allocInfo = {};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorPool = descriptorPool;
+	allocInfo.descriptorSetCount = framesInFlight;
+	allocInfo.pSetLayouts = layouts.data();
+
+	if (vkAllocateDescriptorSets( device, &allocInfo, descriptorSets.data() ) != VK_SUCCESS)
+	{
+		throw runtime_error( "couldn't create culling descriptorsets" );
+	}
+
+	writeDescriptorSets();
+
+	layout = PipelineLayoutBuilder( device )
+		.addDescriptorSetLayout( descriptorLayout )
+		.build();
+
+	cullPipeline = ComputePipelineBuilder( device )
+		.setShader( assets.load( "shaders/cull.spv" ), "main" )
+		.setPipelineLayout( layout )
+		.setPipelineCache( pipelineCache )
+		.build();
+
+	compactPipeline = ComputePipelineBuilder( device )
+		.setShader( assets.load( "shaders/compact.spv" ), "main" )
+		.setPipelineLayout( layout )
+		.setPipelineCache( pipelineCache )
+		.build();
+}
+
+CullingPass::~CullingPass()
+{
+	vkDestroyPipeline( device, cullPipeline, nullptr );
+	vkDestroyPipeline( device, compactPipeline, nullptr );
+	vkDestroyPipelineLayout( device, layout, nullptr );
+	vkDestroyDescriptorPool( device, descriptorPool, nullptr );
+	vkDestroyDescriptorSetLayout( device, descriptorLayout, nullptr );
+
+	delete params;
+	delete objects;
+	delete batches;
+
+	memFac.destroyBuffer( counts, countsMemory );
+	memFac.destroyBuffer( visible, visibleMemory );
+	memFac.destroyBuffer( commands, commandsMemory );
+	memFac.destroyBuffer( drawCount, drawCountMemory );
+}
+
+VkDeviceSize CullingPass::regionStride( VkDeviceSize size )
+{
+	return (size + storageAlignment - 1) / storageAlignment * storageAlignment;
+}
+
+void CullingPass::createDeviceBuffer( VkDeviceSize regionSize, VkBufferUsageFlags usage, VkBuffer& buffer, Allocation& memory )
+{
+	memFac.createBuffer( regionStride( regionSize ) * framesInFlight, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, buffer, memory );
+}
+
+//the buffers never change size, every set is written once
+void CullingPass::writeDescriptorSets()
+{
+	for (uint32_t frame = 0; frame < framesInFlight; frame++)
+	{
+		VkDescriptorBufferInfo bufferInfos[7] =
+		{
+			{ params->getBuffer(), params->getDynamicOffset( frame ), params->getRegionSize() },
+			{ objects->getBuffer(), objects->getDynamicOffset( frame ), objects->getRegionSize() },
+			{ batches->getBuffer(), batches->getDynamicOffset( frame ), batches->getRegionSize() },
+			{ counts, regionStride( sizeof( uint32_t ) * maxBatches ) * frame, sizeof( uint32_t ) * maxBatches },
+			{ visible, getVisibleOffset( frame ), sizeof( glm::mat4 ) * maxObjects },
+			{ commands, regionStride( sizeof( VkDrawIndexedIndirectCommand ) * maxBatches ) * frame, sizeof( VkDrawIndexedIndirectCommand ) * maxBatches },
+			{ drawCount, regionStride( sizeof( uint32_t ) ) * frame, sizeof( uint32_t ) }
+		};
+
+		VkWriteDescriptorSet descriptorWrites[7] = {};
+
+		for (uint32_t binding = 0; binding < 7; binding++)
+		{
+			descriptorWrites[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrites[binding].dstSet = descriptorSets[frame];
+			descriptorWrites[binding].dstBinding = binding;
+			descriptorWrites[binding].dstArrayElement = 0;
+			descriptorWrites[binding].descriptorType = binding == 0 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			descriptorWrites[binding].descriptorCount = 1;
+			descriptorWrites[binding].pBufferInfo = &bufferInfos[binding];
+		}
+
+		vkUpdateDescriptorSets( device, 7, descriptorWrites, 0, nullptr );
+	}
+}
+
+array<glm::vec4, 6> CullingPass::extractFrustum( const glm::mat4& viewProj )
+{
+	//rows of the matrix, glm stores columns
+	glm::vec4 rows[4];
+	for (int i = 0; i < 4; i++)
+	{
+		rows[i] = glm::vec4( viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i] );
+	}
+
+	array<glm::vec4, 6> planes =
+	{
+		rows[3] + rows[0],	//left
+		rows[3] - rows[0],	//right
+		rows[3] + rows[1],	//bottom
+		rows[3] - rows[1],	//top
+		rows[2],			//near, z >= 0
+		rows[3] - rows[2]	//far
+	};
+
+	//normalized, so the distance compares against the radius
+	for (glm::vec4& plane : planes)
+	{
+		plane /= glm::length( glm::vec3( plane ) );
+	}
+
+	return planes;
+}
+
+void CullingPass::update( uint32_t frameIndex, const glm::mat4& viewProj, DrawQueue& queue, const vector<Mesh>& meshes )
+{
+	const vector<DrawBatch>& queueBatches = queue.getBatches();
+	const vector<InstanceData>& instances = queue.getInstances();
+
+	if (instances.size() > maxObjects || queueBatches.size() > maxBatches)
+	{
+		throw out_of_range( "more objects or batches than the culling pass was created for" );
+	}
+
+	objectCount = static_cast<uint32_t>(instances.size());
+	batchCount = static_cast<uint32_t>(queueBatches.size());
+
+	objectData.resize( objectCount );
+	batchData.resize( batchCount );
+
+	for (uint32_t b = 0; b < batchCount; b++)
+	{
+		const DrawBatch& batch = queueBatches[b];
+		const Mesh& mesh = meshes[batch.mesh];
+
+		//instanceCount is filled in by the gpu
+		batchData[b] = { mesh.indexCount, 0, mesh.firstIndex, mesh.vertexOffset, batch.firstInstance };
+
+		for (uint32_t i = batch.firstInstance; i < batch.firstInstance + batch.instanceCount; i++)
+		{
+			objectData[i].model = instances[i].model;
+			objectData[i].sphere = mesh.sphere;
+			objectData[i].batch = b;
+		}
+	}
+
+	CullParams cullParams = {};
+	array<glm::vec4, 6> planes = extractFrustum( viewProj );
+	copy( planes.begin(), planes.end(), cullParams.planes );
+	cullParams.objectCount = objectCount;
+	cullParams.batchCount = batchCount;
+	cullParams.compact = isCompacting() ? 1 : 0;
+
+	params->write( frameIndex, &cullParams, sizeof( cullParams ) );
+	objects->write( frameIndex, objectData.data(), sizeof( CullObject ) * objectCount );
+	batches->write( frameIndex, batchData.data(), sizeof( VkDrawIndexedIndirectCommand ) * batchCount );
+}
+
+void CullingPass::record( VkCommandBuffer cmdBuffer, uint32_t frameIndex )
+{
+	if (batchCount == 0)
+	{
+		return;
+	}
+
+	VkDeviceSize countsOffset = regionStride( sizeof( uint32_t ) * maxBatches ) * frameIndex;
+	VkDeviceSize drawCountOffset = regionStride( sizeof( uint32_t ) ) * frameIndex;
+
+	vkCmdFillBuffer( cmdBuffer, counts, countsOffset, sizeof( uint32_t ) * batchCount, 0 );
+	vkCmdFillBuffer( cmdBuffer, drawCount, drawCountOffset, sizeof( uint32_t ), 0 );
+
+	VkMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+	vkCmdPipelineBarrier( cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+		1, &barrier, 0, nullptr, 0, nullptr );
+
+	vkCmdBindDescriptorSets( cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, layout, 0, 1, &descriptorSets[frameIndex], 0, nullptr );
+
+	vkCmdBindPipeline( cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipeline );
+	vkCmdDispatch( cmdBuffer, (objectCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1 );
+
+	//compact reads the final counts
+	barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+	vkCmdPipelineBarrier( cmdBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+		1, &barrier, 0, nullptr, 0, nullptr );
+
+	vkCmdBindPipeline( cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, compactPipeline );
+	vkCmdDispatch( cmdBuffer, (batchCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1 );
+
+	//the commands and count are read as indirect arguments, the transforms as instance attributes
+	barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+
+	vkCmdPipelineBarrier( cmdBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0,
+		1, &barrier, 0, nullptr, 0, nullptr );
+}
+
+void CullingPass::draw( VkCommandBuffer cmdBuffer, uint32_t frameIndex )
+{
+	if (batchCount == 0)
+	{
+		return;
+	}
+
+	const uint32_t stride = sizeof( VkDrawIndexedIndirectCommand );
+	VkDeviceSize commandsOffset = regionStride( stride * maxBatches ) * frameIndex;
+
+	if (drawIndirectCount != nullptr)
+	{
+		drawIndirectCount( cmdBuffer, commands, commandsOffset, drawCount, regionStride( sizeof( uint32_t ) ) * frameIndex, batchCount, stride );
+	}
+	else
+	{
+		//culled batches are still drawn, with zero instances
+		vkCmdDrawIndexedIndirect( cmdBuffer, commands, commandsOffset, batchCount, stride );
+	}
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <array>
+#include <glm/glm.hpp>
+
+#include "DrawQueue.hpp"
+#include "memory/MemoryAllocator.hpp"
+#include "memory/FrameUniformBuffer.hpp"
+#include "builder/MemoryFactory.hpp"
+#include "asset/AssetLoader.hpp"
+
+using namespace std;
+
+namespace com::gelunox::vulcanUtils
+{
+	//matches CullObject in cull.comp, std430
+	struct CullObject
+	{
+		glm::mat4 model;
+		//bounding sphere in mesh space, center xyz and radius w
+		glm::vec4 sphere;
+		uint32_t batch;
+		uint32_t padding[3];
+	};
+
+	//matches CullParams in the compute shaders, std140
+	struct CullParams
+	{
+		glm::vec4 planes[6];
+		uint32_t objectCount;
+		uint32_t batchCount;
+		//0 writes a command per batch in place, instanceCount 0 for the culled ones
+		uint32_t compact;
+		uint32_t padding;
+	};
+
+	//frustum culling on the gpu, the cpu uploads every object and never reads a result back
+	//cull.comp tests bounding spheres and writes the survivors' transforms per batch, compact.comp turns
+	//the surviving batches into indirect draw commands and a draw count, all in device local memory
+	//recorded into the frame's command buffer ahead of the render pass, so it shares the graphics queue and its ordering
+	class CullingPass
+	{
+	private:
+		VkDevice device;
+		MemoryFactory& memFac;
+		uint32_t framesInFlight;
+		uint32_t maxObjects;
+		uint32_t maxBatches;
+
+		//compacting needs vkCmdDrawIndexedIndirectCountKHR, without it every batch keeps its slot
+		PFN_vkCmdDrawIndexedIndirectCountKHR drawIndirectCount = nullptr;
+
+		VkDescriptorSetLayout descriptorLayout;
+		VkDescriptorPool descriptorPool;
+		//one per frame, the device local regions can't be picked with a dynamic offset per binding
+		vector<VkDescriptorSet> descriptorSets;
+		VkPipelineLayout layout;
+		VkPipeline cullPipeline;
+		VkPipeline compactPipeline;
+
+		//written by the cpu every frame
+		FrameUniformBuffer * params;
+		FrameUniformBuffer * objects;
+		FrameUniformBuffer * batches;
+
+		//written by the gpu, a region per frame in flight
+		VkDeviceSize storageAlignment;
+		VkBuffer counts;
+		Allocation countsMemory;
+		VkBuffer visible;
+		Allocation visibleMemory;
+		VkBuffer commands;
+		Allocation commandsMemory;
+		VkBuffer drawCount;
+		Allocation drawCountMemory;
+
+		vector<CullObject> objectData;
+		vector<VkDrawIndexedIndirectCommand> batchData;
+		uint32_t objectCount = 0;
+		uint32_t batchCount = 0;
+
+	public:
+		//useDrawIndirectCount needs VK_KHR_draw_indirect_count enabled on the device, the device needs multiDrawIndirect either way
+		CullingPass( VkPhysicalDevice physicalDevice, VkDevice device, MemoryAllocator * allocator, MemoryFactory& memFac, AssetLoader& assets, VkPipelineCache pipelineCache,
+			uint32_t framesInFlight, uint32_t maxObjects, uint32_t maxBatches, bool useDrawIndirectCount );
+		~CullingPass();
+
+		//planes point inwards, the near plane assumes the 0 to 1 depth range of GLM_FORCE_DEPTH_ZERO_TO_ONE, defined by the build for every file
+		static array<glm::vec4, 6> extractFrustum( const glm::mat4& viewProj );
+
+		//the batches of a built queue, every mesh needs its bounding sphere
+		void update( uint32_t frameIndex, const glm::mat4& viewProj, DrawQueue& queue, const vector<Mesh>& meshes );
+		//outside of a render pass, before the draws of the same frame
+		void record( VkCommandBuffer cmdBuffer, uint32_t frameIndex );
+		//inside the render pass, with getVisibleBuffer bound as the instance buffer
+		void draw( VkCommandBuffer cmdBuffer, uint32_t frameIndex );
+
+		VkBuffer getVisibleBuffer() { return visible; }
+		VkDeviceSize getVisibleOffset( uint32_t frameIndex ) { return regionStride( sizeof( glm::mat4 ) * maxObjects ) * frameIndex; }
+
+		bool isCompacting() { return drawIndirectCount != nullptr; }
+
+	private:
+		VkDeviceSize regionStride( VkDeviceSize size );
+		void createDeviceBuffer( VkDeviceSize regionSize, VkBufferUsageFlags usage, VkBuffer& buffer, Allocation& memory );
+		void writeDescriptorSets();
+	};
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+
+using namespace glm;
+using namespace std;
+
+namespace com::gelunox::vulcanUtils
+{
+	//per draw data, pushed into the commandbuffer instead of written into a buffer, so it needs no descriptor or upload
+	//it applies to every instance of the draws that follow, per object data stays in InstanceData
+	//devices only have to support 128 bytes of push constants
+	struct DrawConstants
+	{
+		//mesh space transform, applied before the instance's model
+		mat4 model;
+
+		static constexpr VkShaderStageFlags stages = VK_SHADER_STAGE_VERTEX_BIT;
+	};
+
+	static_assert( sizeof( DrawConstants ) <= 128, "DrawConstants exceed the guaranteed push constant size" );
+}
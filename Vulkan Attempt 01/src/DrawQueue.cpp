@@ -0,0 +1,58 @@
+#include "DrawQueue.hpp"
+
+#include <algorithm>
+
+using namespace com::gelunox::vulcanUtils;
+using namespace std;
+
+void DrawQueue::clear()
+{
+	entries.clear();
+	batches.clear();
+	instances.clear();
+}
+
+void DrawQueue::submit( uint32_t mesh, uint32_t material, const glm::mat4& model )
+{
+	entries.push_back( { mesh, material, { model } } );
+}
+
+void DrawQueue::build()
+{
+	//stable, objects keep their submission order inside a batch
+	stable_sort( entries.begin(), entries.end(), []( const Entry& a, const Entry& b )
+	{
+		return a.material != b.material ? a.material < b.material : a.mesh < b.mesh;
+	} );
+
+	batches.clear();
+	instances.clear();
+	instances.reserve( entries.size() );
+
+	for (const Entry& entry : entries)
+	{
+		if (batches.empty() || batches.back().mesh != entry.mesh || batches.back().material != entry.material)
+		{
+			batches.push_back( { entry.mesh, entry.material, static_cast<uint32_t>(instances.size()), 0 } );
+		}
+
+		batches.back().instanceCount++;
+		instances.push_back( entry.instance );
+	}
+}
+
+void DrawQueue::writeIndirectCommands( const vector<Mesh>& meshes, vector<VkDrawIndexedIndirectCommand>& commands )
+{
+	commands.resize( batches.size() );
+
+	for (size_t i = 0; i < batches.size(); i++)
+	{
+		const Mesh& mesh = meshes[batches[i].mesh];
+
+		commands[i].indexCount = mesh.indexCount;
+		commands[i].instanceCount = batches[i].instanceCount;
+		commands[i].firstIndex = mesh.firstIndex;
+		commands[i].vertexOffset = mesh.vertexOffset;
+		commands[i].firstInstance = batches[i].firstInstance;
+	}
+}
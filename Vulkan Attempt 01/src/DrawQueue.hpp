@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+#include "InstanceData.hpp"
+
+using namespace std;
+
+namespace com::gelunox::vulcanUtils
+{
+	enum class DrawMode
+	{
+		INSTANCED,	//one vkCmdDrawIndexed per batch
+		INDIRECT,	//the batches as VkDrawIndexedIndirectCommands in a device local buffer, one multi-draw call
+		CULLED		//like INDIRECT, but a compute pass culls the objects and writes the commands, see CullingPass
+	};
+
+	//an index range of the shared vertex and index buffers
+	struct Mesh
+	{
+		uint32_t indexCount;
+		uint32_t firstIndex;
+		int32_t vertexOffset;
+		//bounding sphere in mesh space, center xyz and radius w, used by the gpu culling
+		glm::vec4 sphere;
+	};
+
+	//objects sharing mesh and material, their instance data is consecutive from firstInstance
+	struct DrawBatch
+	{
+		uint32_t mesh;
+		uint32_t material;
+		uint32_t firstInstance;
+		uint32_t instanceCount;
+	};
+
+	//collects a frame's objects and groups those that share mesh and material into instanced batches
+	class DrawQueue
+	{
+	private:
+		struct Entry
+		{
+			uint32_t mesh;
+			uint32_t material;
+			InstanceData instance;
+		};
+
+		vector<Entry> entries;
+
+		vector<DrawBatch> batches;
+		vector<InstanceData> instances;
+
+	public:
+		void clear();
+		void submit( uint32_t mesh, uint32_t material, const glm::mat4& model );
+
+		//sorted by material first, binding a material is the costlier switch
+		void build();
+
+		uint32_t getObjectCount() { return static_cast<uint32_t>(entries.size()); }
+		const vector<DrawBatch>& getBatches() { return batches; }
+		//ordered to match the batches, upload as is
+		const vector<InstanceData>& getInstances() { return instances; }
+
+		//one command per batch, firstInstance indexes the instance buffer
+		void writeIndirectCommands( const vector<Mesh>& meshes, vector<VkDrawIndexedIndirectCommand>& commands );
+	};
+}
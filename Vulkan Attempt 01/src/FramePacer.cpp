@@ -0,0 +1,148 @@
+#include "FramePacer.hpp"
+
+#include <thread>
+#include <algorithm>
+#include <stdexcept>
+
+using namespace com::gelunox::vulcanUtils;
+using namespace std;
+
+FramePacer::FramePacer( PacingMode mode, double targetFps )
+{
+	setMode( mode, targetFps );
+}
+
+void FramePacer::setMode( PacingMode mode, double targetFps )
+{
+	if (mode != PacingMode::UNCAPPED && targetFps <= 0.0)
+	{
+		throw invalid_argument( "paced modes need a positive target fps" );
+	}
+
+	this->mode = mode;
+	period = targetFps > 0.0
+		? chrono::duration_cast<clock::duration>( chrono::duration<double>( 1.0 / targetFps ) )
+		: clock::duration::zero();
+
+	//resynchronise the cadence on the next frame
+	started = false;
+}
+
+void FramePacer::beginFrame()
+{
+	if (!started)
+	{
+		deadline = clock::now() + period;
+		started = true;
+	}
+
+	if (mode == PacingMode::TARGET_FPS)
+	{
+		waitUntil( deadline - period );
+	}
+
+	frameStart = clock::now();
+	inputSample = frameStart;
+}
+
+void FramePacer::waitForInputSample()
+{
+	if (mode == PacingMode::LOW_LATENCY)
+	{
+		//finish recording right at the deadline instead of idling afterwards with stale input
+		waitUntil( deadline - workEstimate );
+	}
+
+	inputSample = clock::now();
+}
+
+void FramePacer::endFrame()
+{
+	clock::time_point now = clock::now();
+
+	stats.frames++;
+	double frameMs = chrono::duration<double, milli>( now - frameStart ).count();
+	stats.averageFrameMs += (frameMs - stats.averageFrameMs) / stats.frames;
+
+	if (recordFrameTimes)
+	{
+		frameTimes.push_back( frameMs );
+	}
+
+	//grow instantly, shrink slowly, a late input sample costs a whole frame while an early one costs a little latency
+	clock::duration work = now - inputSample;
+	workEstimate = max( work, workEstimate - (workEstimate - work) / 8 );
+
+	if (mode == PacingMode::UNCAPPED)
+	{
+		return;
+	}
+
+	if (now > deadline)
+	{
+		double overshootMs = chrono::duration<double, milli>( now - deadline ).count();
+
+		stats.missedDeadlines++;
+		stats.worstOvershootMs = max( stats.worstOvershootMs, overshootMs );
+	}
+
+	deadline += period;
+
+	//more than a whole frame behind, don't try to catch up with a burst of unpaced frames
+	if (now > deadline)
+	{
+		deadline = now + period;
+	}
+}
+
+void FramePacer::report( ostream& out )
+{
+	double missedPercentage = stats.frames ? 100.0 * stats.missedDeadlines / stats.frames : 0.0;
+
+	out << "frames: " << stats.frames
+		<< " | missed deadlines: " << stats.missedDeadlines << " (" << missedPercentage << "%)"
+		<< " | worst overshoot: " << stats.worstOvershootMs << "ms"
+		<< " | average frame: " << stats.averageFrameMs << "ms" << endl;
+
+	if (frameTimes.empty())
+	{
+		return;
+	}
+
+	vector<double> sorted = frameTimes;
+	sort( sorted.begin(), sorted.end() );
+
+	auto percentile = [&sorted]( double p ) { return sorted[static_cast<size_t>(p * (sorted.size() - 1))]; };
+
+	out << "fps: " << 1000.0 / stats.averageFrameMs
+		<< " | min: " << sorted.front() << "ms"
+		<< " | p50: " << percentile( 0.50 ) << "ms"
+		<< " | p95: " << percentile( 0.95 ) << "ms"
+		<< " | p99: " << percentile( 0.99 ) << "ms"
+		<< " | max: " << sorted.back() << "ms" << endl;
+}
+
+void FramePacer::waitUntil( clock::time_point target )
+{
+	const clock::duration minMargin = chrono::microseconds( 500 );
+	const clock::duration maxMargin = chrono::milliseconds( 4 );
+
+	clock::time_point now = clock::now();
+
+	if (target - now > spinMargin)
+	{
+		clock::time_point wake = target - spinMargin;
+		this_thread::sleep_until( wake );
+
+		//adapt the spin margin to how late the os actually wakes us up
+		clock::duration late = clock::now() - wake;
+		spinMargin = late + minMargin > spinMargin
+			? min( late + minMargin, maxMargin )
+			: max( spinMargin - (spinMargin - late) / 16, minMargin );
+	}
+
+	while (clock::now() < target)
+	{
+		this_thread::yield();
+	}
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+using namespace std;
+
+namespace com::gelunox::vulcanUtils
+{
+	enum class PacingMode
+	{
+		UNCAPPED,		//render as fast as the gpu and present mode allow
+		TARGET_FPS,		//start frames on a fixed cadence
+		LOW_LATENCY		//same cadence, but sample input as late as possible before recording
+	};
+
+	struct PacingStats
+	{
+		uint64_t frames = 0;
+		uint64_t missedDeadlines = 0;
+		double worstOvershootMs = 0.0;
+		double averageFrameMs = 0.0;
+	};
+
+	class FramePacer
+	{
+	private:
+		typedef chrono::steady_clock clock;
+
+		PacingMode mode = PacingMode::UNCAPPED;
+		clock::duration period = clock::duration::zero();
+
+		//sleeping is only accurate to the os scheduler tick, the last stretch before a deadline is spun instead
+		clock::duration spinMargin = chrono::milliseconds( 2 );
+		//time between sampling input and finishing the frame, used to place the input sample in LOW_LATENCY
+		clock::duration workEstimate = clock::duration::zero();
+
+		clock::time_point deadline;
+		clock::time_point frameStart;
+		clock::time_point inputSample;
+		bool started = false;
+
+		PacingStats stats;
+		//every frame time, only kept for benchmarks where the distribution matters
+		bool recordFrameTimes = false;
+		vector<double> frameTimes;
+
+	public:
+		FramePacer() {}
+		FramePacer( PacingMode mode, double targetFps );
+
+		void setMode( PacingMode mode, double targetFps );
+		PacingMode getMode() { return mode; }
+
+		//call at the very start of the frame, TARGET_FPS blocks here until the frame's deadline
+		void beginFrame();
+		//call right before polling input, LOW_LATENCY blocks here so input is as fresh as possible
+		void waitForInputSample();
+		//call once the frame is submitted
+		void endFrame();
+
+		void setRecordFrameTimes( bool enabled ) { recordFrameTimes = enabled; }
+		const vector<double>& getFrameTimes() { return frameTimes; }
+
+		const PacingStats& getStats() { return stats; }
+		//adds fps and frame time percentiles when frame times are recorded
+		void report( ostream& out );
+
+	private:
+		void waitUntil( clock::time_point target );
+	};
+}
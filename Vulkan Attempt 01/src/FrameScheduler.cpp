@@ -0,0 +1,81 @@
+#include "FrameScheduler.hpp"
+
+#include <stdexcept>
+#include <limits>
+
+using namespace com::gelunox::vulcanUtils;
+using namespace std;
+
+//https://vulkan-tutorial.com/Drawing_a_triangle/Drawing/Rendering_and_presentation
+
+FrameScheduler::FrameScheduler( VkDevice device, uint32_t framesInFlight ) : device( device )
+{
+	if (framesInFlight == 0)
+	{
+		throw invalid_argument( "at least one frame has to be in flight" );
+	}
+
+	frames.resize( framesInFlight );
+
+	VkSemaphoreCreateInfo spInfo = {};
+	spInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+	//created signaled so the first wait on every slot returns immediately
+	VkFenceCreateInfo fenceInfo = {};
+	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+	fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+	for (FrameSync& frame : frames)
+	{
+		if (vkCreateSemaphore( device, &spInfo, nullptr, &frame.imageAvailable ) != VK_SUCCESS
+			|| vkCreateSemaphore( device, &spInfo, nullptr, &frame.renderFinished ) != VK_SUCCESS)
+		{
+			throw runtime_error( "semaphore creation failed" );
+		}
+
+		if (vkCreateFence( device, &fenceInfo, nullptr, &frame.inFlight ) != VK_SUCCESS)
+		{
+			throw runtime_error( "fence creation failed" );
+		}
+	}
+}
+
+FrameScheduler::~FrameScheduler()
+{
+	for (FrameSync& frame : frames)
+	{
+		vkDestroySemaphore( device, frame.imageAvailable, nullptr );
+		vkDestroySemaphore( device, frame.renderFinished, nullptr );
+		vkDestroyFence( device, frame.inFlight, nullptr );
+	}
+}
+
+FrameSync& FrameScheduler::waitForFrame()
+{
+	FrameSync& frame = frames[current];
+
+	vkWaitForFences( device, 1, &frame.inFlight, VK_TRUE, numeric_limits<uint64_t>::max() );
+
+	//the fence belonged to the frame one lap ago, everything up to it is done
+	if (frameNumber >= frames.size())
+	{
+		completedFrames = frameNumber - frames.size() + 1;
+	}
+
+	return frame;
+}
+
+VkFence FrameScheduler::resetFence()
+{
+	FrameSync& frame = frames[current];
+
+	vkResetFences( device, 1, &frame.inFlight );
+
+	return frame.inFlight;
+}
+
+void FrameScheduler::advance()
+{
+	current = (current + 1) % frames.size();
+	frameNumber++;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vector>
+
+using namespace std;
+
+namespace com::gelunox::vulcanUtils
+{
+	//synchronisation objects owned by a single frame-in-flight slot
+	struct FrameSync
+	{
+		VkFence inFlight;
+		VkSemaphore imageAvailable;
+		VkSemaphore renderFinished;
+	};
+
+	//hands out frame slots round robin so the cpu can record frame N+1 while the gpu still works on frame N
+	//the cpu only blocks once it laps the oldest frame that is still queued
+	class FrameScheduler
+	{
+	private:
+		VkDevice device;
+
+		vector<FrameSync> frames;
+		uint32_t current = 0;
+
+		//frames are numbered from 0, frameNumber is the one being prepared and the count of submitted ones
+		uint64_t frameNumber = 0;
+		uint64_t completedFrames = 0;
+
+	public:
+		FrameScheduler( VkDevice device, uint32_t framesInFlight );
+		~FrameScheduler();
+
+		uint32_t getFramesInFlight() { return static_cast<uint32_t>(frames.size()); }
+		uint32_t getFrameIndex() { return current; }
+		FrameSync& getFrame() { return frames[current]; }
+		uint64_t getFrameNumber() { return frameNumber; }
+		//every frame numbered below this has finished on the gpu
+		uint64_t getCompletedFrames() { return completedFrames; }
+
+		//blocks until the gpu is done with the previous use of the current slot
+		FrameSync& waitForFrame();
+		//unsignals the fence of the current slot, only call this right before submitting work for it
+		VkFence resetFence();
+		void advance();
+	};
+}
@@ -0,0 +1,62 @@
+#include "GraphicsPipeline.hpp"
+
+using namespace com::gelunox::vulcanUtils;
+using namespace std;
+
+GraphicsPipeline::GraphicsPipeline( VkDevice device, AssetLoader& assets, VkDescriptorSetLayout frameLayout, VkDescriptorSetLayout materialLayout,
+	VkPipelineCache pipelineCache, VkFormat imageFormat, VkImageLayout finalLayout )
+	: device( device ), pipelineCache( pipelineCache ), finalLayout( finalLayout )
+{
+	//loaded once, a format change rebuilds the pipeline from memory
+	vertShader = assets.load( "shaders/vert.spv" );
+	fragShader = assets.load( "shaders/frag.spv" );
+
+	layout = PipelineLayoutBuilder( device )
+		.addDescriptorSetLayout( frameLayout )
+		.addDescriptorSetLayout( materialLayout )
+		.addPushConstantRange( DrawConstants::stages, 0, sizeof( DrawConstants ) )
+		.build();
+
+	setImageFormat( imageFormat );
+}
+
+GraphicsPipeline::~GraphicsPipeline()
+{
+	destroyFormatDependent();
+	vkDestroyPipelineLayout( device, layout, nullptr );
+}
+
+bool GraphicsPipeline::setImageFormat( VkFormat imageFormat )
+{
+	if (imageFormat == this->imageFormat)
+	{
+		return false;
+	}
+
+	destroyFormatDependent();
+	this->imageFormat = imageFormat;
+
+	renderPass = RenderPassBuilder( device )
+		.setImageFormat( imageFormat )
+		.setFinalLayout( finalLayout )
+		.build();
+
+	pipeline = PipelineBuilder( device )
+		.addShaderStage( vertShader, "main", VK_SHADER_STAGE_VERTEX_BIT )
+		.addShaderStage( fragShader, "main", VK_SHADER_STAGE_FRAGMENT_BIT )
+		.setRenderPass( renderPass )
+		.setPipelineLayout( layout )
+		.setPipelineCache( pipelineCache )
+		.build();
+
+	return true;
+}
+
+void GraphicsPipeline::destroyFormatDependent()
+{
+	if (pipeline != VK_NULL_HANDLE)
+	{
+		vkDestroyPipeline( device, pipeline, nullptr );
+		vkDestroyRenderPass( device, renderPass, nullptr );
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vector>
+
+#include "util/Util.hpp"
+#include "DrawConstants.hpp"
+#include "asset/AssetLoader.hpp"
+
+#include "builder/RenderPassBuilder.hpp"
+#include "builder/PipelineBuilder.hpp"
+#include "builder/PipelineLayoutBuilder.hpp"
+
+using namespace std;
+
+namespace com::gelunox::vulcanUtils
+{
+	//render pass, layout and pipeline outlive the swapchain, they only depend on the image format
+	//viewport and scissor are dynamic, so a resize with the same format reuses all of them
+	class GraphicsPipeline
+	{
+	private:
+		VkDevice device;
+		VkPipelineCache pipelineCache;
+
+		//views into the pack when there is one, the loader has to outlive the pipeline
+		AssetData vertShader;
+		AssetData fragShader;
+
+		VkFormat imageFormat = VK_FORMAT_UNDEFINED;
+		VkImageLayout finalLayout;
+
+		VkRenderPass renderPass = VK_NULL_HANDLE;
+		VkPipelineLayout layout;
+		VkPipeline pipeline = VK_NULL_HANDLE;
+
+	public:
+		//finalLayout is the layout the color attachment is left in, PRESENT_SRC_KHR unless the target is never presented
+		//frameLayout is set 0 and materialLayout set 1, DrawConstants are the push constant range
+		GraphicsPipeline( VkDevice device, AssetLoader& assets, VkDescriptorSetLayout frameLayout, VkDescriptorSetLayout materialLayout,
+			VkPipelineCache pipelineCache, VkFormat imageFormat, VkImageLayout finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR );
+		~GraphicsPipeline();
+
+		//rebuilds the render pass and pipeline when the format differs, returns whether it did
+		bool setImageFormat( VkFormat imageFormat );
+
+		VkFormat getImageFormat() { return imageFormat; }
+		VkRenderPass getRenderPass() { return renderPass; }
+		VkPipelineLayout getPipelineLayout() { return layout; }
+		VkPipeline getPipeline() { return pipeline; }
+
+	private:
+		void destroyFormatDependent();
+	};
+}
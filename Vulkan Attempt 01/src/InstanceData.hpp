@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+#include <array>
+
+using namespace glm;
+using namespace std;
+
+namespace com::gelunox::vulcanUtils
+{
+	//per object data, read once per instance from vertex binding 1
+	struct InstanceData
+	{
+		mat4 model;
+
+		static VkVertexInputBindingDescription getBindDescription()
+		{
+			VkVertexInputBindingDescription bindDescription = {};
+			bindDescription.binding = 1;
+			bindDescription.stride = sizeof( InstanceData );
+			bindDescription.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+			return bindDescription;
+		}
+
+		//a mat4 attribute takes a location per column, locations 3 to 6 follow Vertex
+		static array<VkVertexInputAttributeDescription, 4> getAttributeDescriptions()
+		{
+			array<VkVertexInputAttributeDescription, 4> attributeDescriptions = {};
+
+			for (uint32_t column = 0; column < 4; column++)
+			{
+				attributeDescriptions[column].binding = 1;
+				attributeDescriptions[column].location = 3 + column;
+				attributeDescriptions[column].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+				attributeDescriptions[column].offset = offsetof( InstanceData, model ) + sizeof( vec4 ) * column;
+			}
+
+			return attributeDescriptions;
+		}
+	};
+}
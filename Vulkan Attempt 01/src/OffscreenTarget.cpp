@@ -0,0 +1,78 @@
+#include "OffscreenTarget.hpp"
+
+#include <stdexcept>
+
+using namespace com::gelunox::vulcanUtils;
+using namespace std;
+
+OffscreenTarget::OffscreenTarget( VkDevice device, MemoryAllocator * allocator, VkExtent2D extent, VkFormat imageFormat, uint32_t imageCount )
+	: device( device ), allocator( allocator ), extent( extent ), imageFormat( imageFormat )
+{
+	createImages( imageCount );
+}
+
+OffscreenTarget::~OffscreenTarget()
+{
+	for (VkFramebuffer framebuff : frameBuffers)
+	{
+		vkDestroyFramebuffer( device, framebuff, nullptr );
+	}
+
+	for (size_t i = 0; i < images.size(); i++)
+	{
+		vkDestroyImageView( device, imageViews[i], nullptr );
+		vkDestroyImage( device, images[i], nullptr );
+		allocator->free( imageMemory[i] );
+	}
+}
+
+void OffscreenTarget::createImages( uint32_t imageCount )
+{
+	images.resize( imageCount );
+	imageMemory.resize( imageCount );
+	imageViews.resize( imageCount );
+
+	VkImageCreateInfo imageInfo = {};
+	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageInfo.imageType = VK_IMAGE_TYPE_2D;
+	imageInfo.extent.width = extent.width;
+	imageInfo.extent.height = extent.height;
+	imageInfo.extent.depth = 1;
+	imageInfo.mipLevels = 1;
+	imageInfo.arrayLayers = 1;
+	imageInfo.format = imageFormat;
+	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+
+	for (uint32_t i = 0; i < imageCount; i++)
+	{
+		if (vkCreateImage( device, &imageInfo, nullptr, &images[i] ) != VK_SUCCESS)
+		{
+			throw runtime_error( "offscreen image creation failed" );
+		}
+
+		imageMemory[i] = allocator->allocateForImage( images[i], VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT );
+
+		imageViews[i] = ImageViewBuilder( device )
+			.setImage( images[i] )
+			.setFormat( imageFormat )
+			.build();
+	}
+}
+
+void OffscreenTarget::createFrameBuffers( VkRenderPass renderPass )
+{
+	frameBuffers.resize( imageViews.size() );
+
+	for (size_t i = 0; i < imageViews.size(); i++)
+	{
+		frameBuffers[i] = FramebufferBuilder( device )
+			.addAttachment( imageViews[i] )
+			.setRenderPass( renderPass )
+			.setExtent( extent )
+			.build();
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vector>
+
+#include "RenderTarget.hpp"
+#include "memory/MemoryAllocator.hpp"
+
+#include "builder/ImageViewBuilder.hpp"
+#include "builder/FramebufferBuilder.hpp"
+
+using namespace std;
+
+namespace com::gelunox::vulcanUtils
+{
+	//device local color images that stand in for the swapchain when there is no window
+	//nothing is presented, the images are only kept readable as transfer source for captures
+	class OffscreenTarget : public RenderTarget
+	{
+	private:
+		VkDevice device;
+		MemoryAllocator * allocator;
+
+		VkExtent2D extent;
+		VkFormat imageFormat;
+
+		vector<VkImage> images;
+		vector<Allocation> imageMemory;
+		vector<VkImageView> imageViews;
+
+		vector<VkFramebuffer> frameBuffers;
+
+	public:
+		//one image per frame in flight, so a frame never renders into an image the gpu is still writing
+		OffscreenTarget( VkDevice device, MemoryAllocator * allocator, VkExtent2D extent, VkFormat imageFormat, uint32_t imageCount );
+		~OffscreenTarget();
+
+		VkExtent2D getExtent() override { return extent; }
+		VkFormat getImageFormat() override { return imageFormat; }
+		vector<VkImage> getImages() { return images; }
+		vector<VkFramebuffer> getFrameBuffers() override { return frameBuffers; }
+
+		void createFrameBuffers( VkRenderPass renderPass ) override;
+
+	private:
+		void createImages( uint32_t imageCount );
+	};
+}
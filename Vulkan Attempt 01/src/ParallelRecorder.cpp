@@ -0,0 +1,202 @@
+#include "ParallelRecorder.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "profiling/CpuProfiler.hpp"
+
+using namespace com::gelunox::vulcanUtils;
+using namespace std;
+
+ParallelRecorder::ParallelRecorder( VkDevice device, uint32_t queueFamily, uint32_t framesInFlight, uint32_t threadCount, uint32_t minSliceItems )
+	: minSliceItems( max( minSliceItems, 1u ) )
+{
+	if (threadCount == 0)
+	{
+		threadCount = max( thread::hardware_concurrency(), 1u );
+	}
+
+	for (uint32_t i = 0; i < threadCount; i++)
+	{
+		recorders.push_back( new CommandBufferAllocator( device, queueFamily, framesInFlight, VK_COMMAND_BUFFER_LEVEL_SECONDARY ) );
+	}
+	recorded.resize( threadCount );
+
+	//recorder 0 belongs to the calling thread
+	for (uint32_t i = 1; i < threadCount; i++)
+	{
+		workers.emplace_back( &ParallelRecorder::workerLoop, this, i );
+	}
+}
+
+ParallelRecorder::~ParallelRecorder()
+{
+	{
+		lock_guard<mutex> guard( lock );
+		stopping = true;
+	}
+	workReady.notify_all();
+
+	for (thread& worker : workers)
+	{
+		worker.join();
+	}
+
+	for (CommandBufferAllocator * recorder : recorders)
+	{
+		delete recorder;
+	}
+}
+
+CommandBufferStats ParallelRecorder::getTotalStats()
+{
+	CommandBufferStats total;
+
+	for (CommandBufferAllocator * recorder : recorders)
+	{
+		total.add( recorder->getTotalStats() );
+	}
+
+	return total;
+}
+
+CommandBufferStats ParallelRecorder::getLastFrameStats()
+{
+	CommandBufferStats lastFrame;
+
+	for (CommandBufferAllocator * recorder : recorders)
+	{
+		lastFrame.add( recorder->getLastFrameStats() );
+	}
+
+	return lastFrame;
+}
+
+vector<VkCommandBuffer> ParallelRecorder::record( uint32_t frameIndex, const VkCommandBufferInheritanceInfo& inheritance, uint32_t itemCount, const SliceRecorder& recordSlice )
+{
+	uint32_t slices = min( getThreadCount(), max( (itemCount + minSliceItems - 1) / minSliceItems, 1u ) );
+
+	{
+		lock_guard<mutex> guard( lock );
+
+		jobFrame = frameIndex;
+		jobSlices = slices;
+		jobItems = itemCount;
+		jobInheritance = &inheritance;
+		jobRecorder = &recordSlice;
+		jobError = nullptr;
+
+		pending = slices - 1;
+		generation++;
+	}
+
+	if (slices > 1)
+	{
+		workReady.notify_all();
+	}
+
+	try
+	{
+		this->recordSlice( 0 );
+	}
+	catch (...)
+	{
+		lock_guard<mutex> guard( lock );
+		jobError = current_exception();
+	}
+
+	{
+		unique_lock<mutex> guard( lock );
+		workDone.wait( guard, [this] { return pending == 0; } );
+
+		jobInheritance = nullptr;
+		jobRecorder = nullptr;
+
+		if (jobError)
+		{
+			rethrow_exception( jobError );
+		}
+	}
+
+	return vector<VkCommandBuffer>( recorded.begin(), recorded.begin() + slices );
+}
+
+void ParallelRecorder::workerLoop( uint32_t recorderIndex )
+{
+	uint64_t seenGeneration = 0;
+
+	while (true)
+	{
+		{
+			unique_lock<mutex> guard( lock );
+			workReady.wait( guard, [&] { return stopping || generation != seenGeneration; } );
+
+			if (stopping)
+			{
+				return;
+			}
+
+			seenGeneration = generation;
+
+			//not needed for this job, the slot's pool is left untouched
+			if (recorderIndex >= jobSlices)
+			{
+				continue;
+			}
+		}
+
+		exception_ptr error;
+
+		try
+		{
+			recordSlice( recorderIndex );
+		}
+		catch (...)
+		{
+			error = current_exception();
+		}
+
+		{
+			lock_guard<mutex> guard( lock );
+
+			if (error)
+			{
+				jobError = error;
+			}
+
+			if (--pending == 0)
+			{
+				workDone.notify_one();
+			}
+		}
+	}
+}
+
+//job fields are only written while no slice is being recorded, reading them here needs no lock
+void ParallelRecorder::recordSlice( uint32_t recorderIndex )
+{
+	CpuScope scope( "recordSlice" );
+
+	//the frame's fence has signaled, nothing from this slot's pool is still executing
+	CommandBufferAllocator * recorder = recorders[recorderIndex];
+	recorder->beginFrame( jobFrame );
+
+	VkCommandBuffer cmdBuffer = recorder->allocate();
+	recorded[recorderIndex] = cmdBuffer;
+
+	VkCommandBufferBeginInfo beginInfo = {};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+	beginInfo.pInheritanceInfo = jobInheritance;
+
+	vkBeginCommandBuffer( cmdBuffer, &beginInfo );
+
+	uint32_t first = static_cast<uint32_t>(static_cast<uint64_t>(jobItems) * recorderIndex / jobSlices);
+	uint32_t last = static_cast<uint32_t>(static_cast<uint64_t>(jobItems) * (recorderIndex + 1) / jobSlices);
+	(*jobRecorder)( cmdBuffer, first, last - first );
+
+	if (vkEndCommandBuffer( cmdBuffer ) != VK_SUCCESS)
+	{
+		throw runtime_error( "secondary command buffer recording failed" );
+	}
+}
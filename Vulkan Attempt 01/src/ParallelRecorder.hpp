@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+
+#include "CommandBufferAllocator.hpp"
+
+using namespace std;
+
+namespace com::gelunox::vulcanUtils
+{
+	//records slices of a draw list into secondary command buffers on several threads
+	//every thread owns a command pool per frame in flight, so recording never shares a pool between threads
+	//the calling thread records the first slice itself, the others go to persistent worker threads
+	class ParallelRecorder
+	{
+	public:
+		//records items [first, first + count) into a secondary buffer that is already begun
+		typedef function<void( VkCommandBuffer cmdBuffer, uint32_t first, uint32_t count )> SliceRecorder;
+
+	private:
+		//below this many items per slice the thread hand-off costs more than it saves
+		uint32_t minSliceItems;
+
+		//one per thread, each with a secondary buffer pool per frame slot
+		vector<CommandBufferAllocator *> recorders;
+		//the buffer each recorder filled for the current job
+		vector<VkCommandBuffer> recorded;
+		vector<thread> workers;
+
+		mutex lock;
+		condition_variable workReady;
+		condition_variable workDone;
+		uint64_t generation = 0;
+		uint32_t pending = 0;
+		bool stopping = false;
+
+		//the job of the current generation
+		uint32_t jobFrame = 0;
+		uint32_t jobSlices = 0;
+		uint32_t jobItems = 0;
+		const VkCommandBufferInheritanceInfo * jobInheritance = nullptr;
+		const SliceRecorder * jobRecorder = nullptr;
+		exception_ptr jobError;
+
+	public:
+		//threadCount includes the calling thread, 0 picks one per hardware thread
+		ParallelRecorder( VkDevice device, uint32_t queueFamily, uint32_t framesInFlight, uint32_t threadCount = 0, uint32_t minSliceItems = 256 );
+		~ParallelRecorder();
+
+		uint32_t getThreadCount() { return static_cast<uint32_t>(recorders.size()); }
+		CommandBufferStats getTotalStats();
+		//summed over the threads, each counts the last frame it recorded for
+		CommandBufferStats getLastFrameStats();
+
+		//only call once the fence of frameIndex has signaled, the slot's pools are reset here
+		//returns the secondary buffers in draw list order, ready for vkCmdExecuteCommands
+		vector<VkCommandBuffer> record( uint32_t frameIndex, const VkCommandBufferInheritanceInfo& inheritance, uint32_t itemCount, const SliceRecorder& recordSlice );
+
+	private:
+		void workerLoop( uint32_t recorderIndex );
+		void recordSlice( uint32_t recorderIndex );
+	};
+}
@@ -0,0 +1,128 @@
+#include "PipelineCache.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+#include <stdexcept>
+#include <cstring>
+
+using namespace com::gelunox::vulcanUtils;
+using namespace std;
+
+//layout of VK_PIPELINE_CACHE_HEADER_VERSION_ONE, the start of every cache blob
+struct CacheHeader
+{
+	uint32_t headerLength;
+	uint32_t headerVersion;
+	uint32_t vendorID;
+	uint32_t deviceID;
+	uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+};
+
+PipelineCache::PipelineCache( VkPhysicalDevice physicalDevice, VkDevice device, string path ) : device( device ), path( path )
+{
+	vkGetPhysicalDeviceProperties( physicalDevice, &deviceProps );
+
+	vector<char> data = load();
+
+	VkPipelineCacheCreateInfo cacheInfo = {};
+	cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	cacheInfo.initialDataSize = data.size();
+	cacheInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+	if (vkCreatePipelineCache( device, &cacheInfo, nullptr, &cache ) != VK_SUCCESS)
+	{
+		throw runtime_error( "pipeline cache creation failed" );
+	}
+}
+
+PipelineCache::~PipelineCache()
+{
+	try
+	{
+		save();
+	}
+	catch (exception& e)
+	{
+		cerr << "pipeline cache not saved: " << e.what() << endl;
+	}
+
+	vkDestroyPipelineCache( device, cache, nullptr );
+}
+
+void PipelineCache::save()
+{
+	size_t size = 0;
+	vkGetPipelineCacheData( device, cache, &size, nullptr );
+
+	vector<char> data( size );
+	if (vkGetPipelineCacheData( device, cache, &size, data.data() ) != VK_SUCCESS)
+	{
+		throw runtime_error( "couldn't read pipeline cache data" );
+	}
+	data.resize( size );
+
+	string tempPath = path + ".tmp";
+	{
+		ofstream file( tempPath, ios::binary | ios::trunc );
+
+		if (!file.is_open())
+		{
+			throw runtime_error( "can't open file" );
+		}
+
+		file.write( data.data(), data.size() );
+
+		if (!file)
+		{
+			throw runtime_error( "can't write file" );
+		}
+	}
+
+	//replaces the old cache in one step
+	filesystem::rename( tempPath, path );
+}
+
+vector<char> PipelineCache::load()
+{
+	ifstream file( path, ios::ate | ios::binary );
+
+	//no cache yet, the driver starts empty
+	if (!file.is_open())
+	{
+		return vector<char>();
+	}
+
+	size_t fileSize = static_cast<size_t>(file.tellg());
+	vector<char> data( fileSize );
+
+	file.seekg( 0 );
+	file.read( data.data(), fileSize );
+
+	if (!file || !isCompatible( data ))
+	{
+		cout << "ignoring pipeline cache " << path << ", it doesn't match this device" << endl;
+		return vector<char>();
+	}
+
+	return data;
+}
+
+bool PipelineCache::isCompatible( const vector<char>& data )
+{
+	if (data.size() < sizeof( CacheHeader ))
+	{
+		return false;
+	}
+
+	CacheHeader header;
+	memcpy( &header, data.data(), sizeof( header ) );
+
+	//the uuid changes with the driver version, the rest rules out other gpus and truncated files
+	return header.headerLength >= sizeof( CacheHeader )
+		&& header.headerLength <= data.size()
+		&& header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+		&& header.vendorID == deviceProps.vendorID
+		&& header.deviceID == deviceProps.deviceID
+		&& memcmp( header.pipelineCacheUUID, deviceProps.pipelineCacheUUID, VK_UUID_SIZE ) == 0;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace com::gelunox::vulcanUtils
+{
+	//VkPipelineCache that survives restarts, loaded on construction and written back on destruction
+	//a file from another gpu or driver is ignored instead of handed to the driver
+	class PipelineCache
+	{
+	private:
+		VkDevice device;
+		VkPhysicalDeviceProperties deviceProps;
+		string path;
+
+		VkPipelineCache cache;
+
+	public:
+		PipelineCache( VkPhysicalDevice physicalDevice, VkDevice device, string path = "pipeline.cache" );
+		~PipelineCache();
+
+		VkPipelineCache getCache() { return cache; }
+
+		//writes to a temporary file first, a crash halfway leaves the previous cache intact
+		void save();
+
+	private:
+		vector<char> load();
+		bool isCompatible( const vector<char>& data );
+	};
+}
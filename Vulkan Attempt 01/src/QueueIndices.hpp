@@ -11,12 +11,26 @@ namespace com::gelunox::vulcanUtils
 	{
 		int graphics = -1;
 		int presentation = -1;
+		//family without graphics support for uploads, -1 when the device has none and uploads share the graphics queue
+		int transfer = -1;
+		//the graphics family when it also supports compute, culling dispatches go into the frame's own command buffer
+		int compute = -1;
 		
 		bool isComplete()
 		{
 			return graphics >= 0 && presentation >= 0;
 		}
 
+		bool hasDedicatedTransfer()
+		{
+			return transfer >= 0 && transfer != graphics;
+		}
+
+		int uploadFamily()
+		{
+			return hasDedicatedTransfer() ? transfer : graphics;
+		}
+
 		set<uint32_t> asSet()
 		{
 			set<uint32_t> set =
@@ -35,5 +49,17 @@ namespace com::gelunox::vulcanUtils
 			copy( set.begin(), set.end(), back_inserter( vec ) );
 			return vec;
 		}
+
+		//asList is what the swapchain is shared with, the device also needs a queue from the transfer family
+		vector<uint32_t> deviceQueueList()
+		{
+			set<uint32_t> set = this->asSet();
+			if (hasDedicatedTransfer())
+			{
+				set.insert( static_cast<uint32_t>(transfer) );
+			}
+
+			return vector<uint32_t>( set.begin(), set.end() );
+		}
 	};
 }
\ No newline at end of file
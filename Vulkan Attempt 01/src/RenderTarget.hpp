@@ -0,0 +1,23 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vector>
+
+using namespace std;
+
+namespace com::gelunox::vulcanUtils
+{
+	//the images a frame renders into, the swapchain when presenting and an OffscreenTarget when headless
+	class RenderTarget
+	{
+	public:
+		virtual ~RenderTarget() {}
+
+		virtual VkExtent2D getExtent() = 0;
+		virtual VkFormat getImageFormat() = 0;
+		virtual vector<VkFramebuffer> getFrameBuffers() = 0;
+
+		//the render pass lives outside the target, call once it matches getImageFormat()
+		virtual void createFrameBuffers( VkRenderPass renderPass ) = 0;
+	};
+}
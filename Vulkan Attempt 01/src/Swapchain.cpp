@@ -4,31 +4,22 @@ using namespace com::gelunox::vulcanUtils;
 using namespace std;
 
 Swapchain::Swapchain( int width, int height, VkPhysicalDevice physicalDevice, VkDevice device,
-	VkSurfaceKHR surface, QueueIndices queueIndices, VkDescriptorSetLayout descriptorLayout )
-	:Swapchain(width, height, physicalDevice, device, surface, queueIndices, descriptorLayout, nullptr)
+	VkSurfaceKHR surface, QueueIndices queueIndices )
+	:Swapchain(width, height, physicalDevice, device, surface, queueIndices, nullptr)
 {
 
 }
 
 Swapchain::Swapchain( int width, int height, VkPhysicalDevice physicalDevice, VkDevice device,
-	VkSurfaceKHR surface, QueueIndices queueIndices, VkDescriptorSetLayout descriptorLayout, Swapchain * oldSwapchain )
+	VkSurfaceKHR surface, QueueIndices queueIndices, Swapchain * oldSwapchain )
 	: device( device ), width( width ), height( height )
 {
 	createSwapchain( physicalDevice, device, surface, queueIndices, oldSwapchain ? oldSwapchain->getSwapchain() : VK_NULL_HANDLE );
 	createImages();
-	
-	createRenderpass( imageFormat );
-	createPipeline( descriptorLayout );
-
-	createFrameBuffers();
 }
 
 Swapchain::~Swapchain()
 {
-	vkDestroyPipeline( device, graphics, nullptr );
-	vkDestroyPipelineLayout( device, layout, nullptr );
-	vkDestroyRenderPass( device, renderPass, nullptr );
-
 	for (VkFramebuffer framebuff : frameBuffers)
 	{
 		vkDestroyFramebuffer( device, framebuff, nullptr );
@@ -86,33 +77,7 @@ void Swapchain::createImages()
 	}
 }
 
-void Swapchain::createRenderpass( VkFormat imageFormat )
-{
-	renderPass = RenderPassBuilder( device )
-		.setImageFormat( imageFormat )
-		.build();
-}
-
-void Swapchain::createPipeline( VkDescriptorSetLayout descriptorLayout )
-{
-	//shaders
-	vector<char> vertShader = Util::readFile( "shaders/vert.spv" );
-	vector<char> fragShader = Util::readFile( "shaders/frag.spv" );
-
-	layout = PipelineLayoutBuilder( device )
-		.addDescriptorSetLayout( descriptorLayout )
-		.build();
-
-	graphics = PipelineBuilder( device )
-		.addShaderStage( vertShader, "main", VK_SHADER_STAGE_VERTEX_BIT )
-		.addShaderStage( fragShader, "main", VK_SHADER_STAGE_FRAGMENT_BIT )
-		.setImageExtent( extent )
-		.setRenderPass( renderPass )
-		.setPipelineLayout( layout )
-		.build();
-}
-
-void Swapchain::createFrameBuffers()
+void Swapchain::createFrameBuffers( VkRenderPass renderPass )
 {
 	frameBuffers.resize( imageViews.size() );
 
@@ -4,22 +4,20 @@
 #include <vector>
 
 #include "QueueIndices.hpp"
+#include "RenderTarget.hpp"
 #include "util/Util.hpp"
 #include "Vertex.hpp"
 
 #include "builder/SwapchainBuilder.hpp"
 #include "builder/ImageViewBuilder.hpp"
 #include "builder/FramebufferBuilder.hpp"
-#include "builder/RenderPassBuilder.hpp"
-#include "builder/PipelineBuilder.hpp"
-#include "builder/PipelineLayoutBuilder.hpp"
 
 
 using namespace std;
 
 namespace com::gelunox::vulcanUtils
 {
-	class Swapchain
+	class Swapchain : public RenderTarget
 	{
 	private:
 		const int width;
@@ -35,35 +33,27 @@ namespace com::gelunox::vulcanUtils
 		vector<VkImage> images;
 		vector<VkImageView> imageViews;
 
-		VkRenderPass renderPass;
-		VkPipeline graphics;
-		VkPipelineLayout layout;
-
 		vector<VkFramebuffer> frameBuffers;
 
 	public:
 		Swapchain( int width, int height, VkPhysicalDevice physicalDevice, VkDevice device,
-			VkSurfaceKHR surface, QueueIndices queueIndices, VkDescriptorSetLayout descriptorLayout );
+			VkSurfaceKHR surface, QueueIndices queueIndices );
 		Swapchain( int width, int height, VkPhysicalDevice physicalDevice, VkDevice device,
-			VkSurfaceKHR surface, QueueIndices queueIndices, VkDescriptorSetLayout descriptorLayout, Swapchain * oldSwapchain );
+			VkSurfaceKHR surface, QueueIndices queueIndices, Swapchain * oldSwapchain );
 		~Swapchain();
 
 		VkSwapchainKHR getSwapchain() { return swapchain; }
 
-		VkExtent2D getExtent() { return extent; }
-		VkFormat getImageFormat() { return imageFormat; }
+		VkExtent2D getExtent() override { return extent; }
+		VkFormat getImageFormat() override { return imageFormat; }
 		vector<VkImage> getImages() { return images; }
 		vector<VkImageView> getImageViews() { return imageViews; }
-		VkRenderPass getRenderPass() { return renderPass; }
-		VkPipeline getPipeline() { return graphics; }
-		VkPipelineLayout getPipelineLayout() { return layout; }
-		vector<VkFramebuffer> getFrameBuffers() { return frameBuffers; }
+		vector<VkFramebuffer> getFrameBuffers() override { return frameBuffers; }
+
+		void createFrameBuffers( VkRenderPass renderPass ) override;
 
 	private:
 		void createSwapchain( VkPhysicalDevice physicalDevice, VkDevice device, VkSurfaceKHR surface, QueueIndices queueIndices, VkSwapchainKHR oldSwapchain );
 		void createImages();
-		void createRenderpass( VkFormat imageFormat );
-		void createPipeline( VkDescriptorSetLayout descriptorLayout );
-		void createFrameBuffers();
 	};
 }
\ No newline at end of file
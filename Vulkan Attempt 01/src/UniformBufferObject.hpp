@@ -9,9 +9,10 @@ using namespace std;
 
 namespace com::gelunox::vulcanUtils
 {
+	//per frame data in set 0, written once a frame into the frame's region of a dynamic uniform buffer
+	//anything per object comes from InstanceData or DrawConstants instead
 	struct UniformBufferObject
 	{
-		mat4 model;
 		mat4 view;
 		mat4 proj;
 	};
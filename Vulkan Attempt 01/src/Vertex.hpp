@@ -2,48 +2,141 @@
 
 #include <vulkan/vulkan.h>
 #include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
 #include <array>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 
 using namespace glm;
 using namespace std;
 
 namespace com::gelunox::vulcanUtils
 {
-	struct Vertex
+	//attribute encodings for VertexLayout: the stored type, its format and how a full precision value is packed into it
+	//getError is the largest difference a component has after packing, clamping counts as much as rounding does
+	//the shaders read all of them as floats, so switching an encoding needs no shader change
+	struct Float2
 	{
-		vec2 position;
-		vec3 color;
-		vec2 texCoord;
+		typedef vec2 Type;
+		static constexpr VkFormat format = VK_FORMAT_R32G32_SFLOAT;
+		static Type pack( vec2 value ) { return value; }
+		static float getError( vec2 ) { return 0.0f; }
+	};
+
+	struct Float3
+	{
+		typedef vec3 Type;
+		static constexpr VkFormat format = VK_FORMAT_R32G32B32_SFLOAT;
+		static Type pack( vec3 value ) { return value; }
+		static float getError( vec3 ) { return 0.0f; }
+	};
+
+	//three 16 bit components are rarely supported as a vertex format, the fourth one is padding and reads as 1
+	//half floats keep about three significant digits, plenty for a mesh a few units around its origin
+	struct Half4
+	{
+		typedef array<uint16_t, 4> Type;
+		static constexpr VkFormat format = VK_FORMAT_R16G16B16A16_SFLOAT;
+		static Type pack( vec3 value ) { return { packHalf1x16( value.x ), packHalf1x16( value.y ), packHalf1x16( value.z ), packHalf1x16( 1.0f ) }; }
+		//infinite past the 65504 half floats end at
+		static float getError( vec3 value )
+		{
+			Type packed = pack( value );
+			return std::max( std::abs( unpackHalf1x16( packed[0] ) - value.x ), std::max( std::abs( unpackHalf1x16( packed[1] ) - value.y ), std::abs( unpackHalf1x16( packed[2] ) - value.z ) ) );
+		}
+	};
+
+	//for values already in -1..1, like normals or positions scaled by their bounds, anything outside is clamped
+	struct Snorm16x4
+	{
+		typedef array<uint16_t, 4> Type;
+		static constexpr VkFormat format = VK_FORMAT_R16G16B16A16_SNORM;
+		static Type pack( vec3 value ) { return { packSnorm1x16( value.x ), packSnorm1x16( value.y ), packSnorm1x16( value.z ), packSnorm1x16( 1.0f ) }; }
+		static float getError( vec3 value )
+		{
+			Type packed = pack( value );
+			return std::max( std::abs( unpackSnorm1x16( packed[0] ) - value.x ), std::max( std::abs( unpackSnorm1x16( packed[1] ) - value.y ), std::abs( unpackSnorm1x16( packed[2] ) - value.z ) ) );
+		}
+	};
+
+	//colors, alpha is always opaque
+	struct Unorm8x4
+	{
+		typedef array<uint8_t, 4> Type;
+		static constexpr VkFormat format = VK_FORMAT_R8G8B8A8_UNORM;
+		static Type pack( vec3 value ) { return { packUnorm1x8( value.x ), packUnorm1x8( value.y ), packUnorm1x8( value.z ), packUnorm1x8( 1.0f ) }; }
+		static float getError( vec3 value )
+		{
+			Type packed = pack( value );
+			return std::max( std::abs( unpackUnorm1x8( packed[0] ) - value.x ), std::max( std::abs( unpackUnorm1x8( packed[1] ) - value.y ), std::abs( unpackUnorm1x8( packed[2] ) - value.z ) ) );
+		}
+	};
 
-		static VkVertexInputBindingDescription getBindDescription()
+	//texture coordinates in 0..1, anything outside is clamped, so no repeating textures
+	struct Unorm16x2
+	{
+		typedef array<uint16_t, 2> Type;
+		static constexpr VkFormat format = VK_FORMAT_R16G16_UNORM;
+		static Type pack( vec2 value ) { return { packUnorm1x16( value.x ), packUnorm1x16( value.y ) }; }
+		static float getError( vec2 value )
 		{
-			VkVertexInputBindingDescription bindDescription = {};
-			bindDescription.binding = 0;
-			bindDescription.stride = sizeof( Vertex );
-			bindDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+			Type packed = pack( value );
+			return std::max( std::abs( unpackUnorm1x16( packed[0] ) - value.x ), std::abs( unpackUnorm1x16( packed[1] ) - value.y ) );
+		}
+	};
 
-			return bindDescription;
+	//a vertex of position, color and texCoord in locations 0 to 2 of binding 0, each stored in the given encoding
+	//the descriptions follow from the encodings at compile time
+	template<typename PositionFormat, typename ColorFormat, typename TexCoordFormat>
+	struct VertexLayout
+	{
+		typename PositionFormat::Type position;
+		typename ColorFormat::Type color;
+		typename TexCoordFormat::Type texCoord;
+
+		static constexpr VkVertexInputBindingDescription getBindDescription()
+		{
+			return { 0, sizeof( VertexLayout ), VK_VERTEX_INPUT_RATE_VERTEX };
 		}
 
-		static array<VkVertexInputAttributeDescription, 3> getAttributeDescriptions()
+		static constexpr array<VkVertexInputAttributeDescription, 3> getAttributeDescriptions()
 		{
-			array<VkVertexInputAttributeDescription, 3> attributeDescriptions = {};
-			attributeDescriptions[0].binding = 0;
-			attributeDescriptions[0].location = 0;
-			attributeDescriptions[0].format = VK_FORMAT_R32G32_SFLOAT;
-			attributeDescriptions[0].offset = offsetof( Vertex, position );
+			return { {
+				{ 0, 0, PositionFormat::format, offsetof( VertexLayout, position ) },
+				{ 1, 0, ColorFormat::format, offsetof( VertexLayout, color ) },
+				{ 2, 0, TexCoordFormat::format, offsetof( VertexLayout, texCoord ) }
+			} };
+		}
 
-			attributeDescriptions[1].binding = 0;
-			attributeDescriptions[1].location = 1;
-			attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-			attributeDescriptions[1].offset = offsetof( Vertex, color );
+		//identifies the layout in cooked meshes, the core formats all fit in a byte
+		static constexpr uint32_t getLayoutId()
+		{
+			return PositionFormat::format | ColorFormat::format << 8 | TexCoordFormat::format << 16;
+		}
 
-			attributeDescriptions[2].binding = 0;
-			attributeDescriptions[2].location = 2;
-			attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
-			attributeDescriptions[2].offset = offsetof( Vertex, texCoord );
+		//quantises a vertex of any layout with full precision members
+		template<typename Source>
+		static VertexLayout pack( const Source& vertex )
+		{
+			return { PositionFormat::pack( vertex.position ), ColorFormat::pack( vertex.color ), TexCoordFormat::pack( vertex.texCoord ) };
+		}
 
-			return attributeDescriptions;
+		//what pack loses of position, color and texCoord, each the largest error of their components
+		template<typename Source>
+		static vec3 getErrors( const Source& vertex )
+		{
+			return vec3( PositionFormat::getError( vertex.position ), ColorFormat::getError( vertex.color ), TexCoordFormat::getError( vertex.texCoord ) );
 		}
 	};
-}
\ No newline at end of file
+
+	//full precision, what the mesh importer and optimiser work on
+	typedef VertexLayout<Float3, Float3, Float2> Vertex;
+
+	//what a cooked .mesh stores and the pipelines read, half the size of Vertex
+	//a layout change needs the meshes cooked again
+	typedef VertexLayout<Half4, Unorm8x4, Unorm16x2> PackedVertex;
+
+	static_assert( sizeof( Vertex ) == 32, "Vertex has padding, the importer hashes and compares its bytes" );
+	static_assert( sizeof( PackedVertex ) == 16, "PackedVertex has padding" );
+}
@@ -1,6 +1,7 @@
 #include "VulkanWindow.hpp"
 
 #include <iostream>
+#include <cstring>
 
 using namespace com::gelunox::vulcanUtils;
 using namespace std;
@@ -41,10 +42,36 @@ void VulkanWindow::selectPhysicalDevice()
 		}
 	}
 
+	//software rasterizers such as lavapipe report as a cpu, headless benchmarks have to run on them too
+	if (physicalDevice == VK_NULL_HANDLE && headless)
+	{
+		physicalDevice = devices[0];
+	}
+
 	if (physicalDevice == VK_NULL_HANDLE)
 	{
 		throw runtime_error( "No suitable gpu was found" );
 	}
+
+	VkPhysicalDeviceProperties deviceProps;
+	vkGetPhysicalDeviceProperties( physicalDevice, &deviceProps );
+	vkGetPhysicalDeviceFeatures( physicalDevice, &deviceFeatures );
+
+	cout << "using " << deviceProps.deviceName << endl;
+
+	uint32_t extensionCount = 0;
+	vkEnumerateDeviceExtensionProperties( physicalDevice, nullptr, &extensionCount, nullptr );
+	vector<VkExtensionProperties> extensions( extensionCount );
+	vkEnumerateDeviceExtensionProperties( physicalDevice, nullptr, &extensionCount, extensions.data() );
+
+	for (auto& extension : extensions)
+	{
+		if (strcmp( extension.extensionName, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME ) == 0)
+		{
+			drawIndirectCountSupported = true;
+		}
+	}
+
 	memFac.setPhysicalDevice( physicalDevice );
 }
 
@@ -52,12 +79,26 @@ void VulkanWindow::createLogicalDevice()
 {
 	//Logical device creation
 	LogicalDeviceBuilder builder = LogicalDeviceBuilder( physicalDevice )
-		.addExtensions( deviceExtensions )
-		.setFeatureSamplerAnisotrophy( VK_TRUE )
+		.setFeatureSamplerAnisotrophy( deviceFeatures.samplerAnisotropy )
+		.setFeatureMultiDrawIndirect( deviceFeatures.multiDrawIndirect )
+		.setFeatureDrawIndirectFirstInstance( deviceFeatures.drawIndirectFirstInstance )
+		.setFeatureTextureCompressionBC( deviceFeatures.textureCompressionBC )
 		.setValidationLayersEnabled(enableValidationLayers);
 
+	//the swapchain extension is only needed to present
+	if (!headless)
+	{
+		builder.addExtensions( deviceExtensions );
+	}
+
+	//lets the culling pass draw only the batches that survived, without reading the count back
+	if (drawIndirectCountSupported)
+	{
+		builder.addExtension( VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME );
+	}
+
 	float queuePriority = 1.0f;
-	auto indices = queueIndices.asList();
+	auto indices = queueIndices.deviceQueueList();
 
 	for (auto index : indices)
 	{
@@ -75,7 +116,20 @@ void VulkanWindow::createLogicalDevice()
 	//retrieve queue handle
 	vkGetDeviceQueue( logicalDevice, queueIndices.graphics, 0, &graphicsQ );
 	vkGetDeviceQueue( logicalDevice, queueIndices.presentation, 0, &presentQ );
+	vkGetDeviceQueue( logicalDevice, queueIndices.uploadFamily(), 0, &transferQ );
+
+	allocator = new MemoryAllocator( physicalDevice, logicalDevice );
+	stagingRing = new StagingRing( logicalDevice, allocator );
 
 	memFac.setLogicalDevice( logicalDevice );
-	memFac.setBufferCopyQueue( graphicsQ );
+	memFac.setAllocator( allocator );
+	memFac.setStagingRing( stagingRing );
+	memFac.setBufferCopyQueue( transferQ );
+	memFac.setGraphicsQueue( graphicsQ );
+	memFac.setQueueFamilies( queueIndices.uploadFamily(), queueIndices.graphics );
+
+	if (reportStats && queueIndices.hasDedicatedTransfer())
+	{
+		cout << "uploads use dedicated transfer queue family " << queueIndices.transfer << endl;
+	}
 }
@@ -12,7 +12,8 @@ void VulkanWindow::createCommandpool()
 	VkCommandPoolCreateInfo poolInfo = {};
 	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
 	poolInfo.queueFamilyIndex = queueIndices.graphics;
-	poolInfo.flags = 0;
+	//upload buffers are short lived and recycled one by one once their batch finishes
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
 
 	if (vkCreateCommandPool( logicalDevice, &poolInfo, nullptr, &commandpool ) != VK_SUCCESS)
 	{
@@ -20,178 +21,421 @@ void VulkanWindow::createCommandpool()
 	}
 
 	memFac.setCommandPool( commandpool );
+	memFac.setGraphicsCommandPool( commandpool );
+
+	if (queueIndices.hasDedicatedTransfer())
+	{
+		poolInfo.queueFamilyIndex = queueIndices.transfer;
+
+		if (vkCreateCommandPool( logicalDevice, &poolInfo, nullptr, &transferCommandpool ) != VK_SUCCESS)
+		{
+			throw runtime_error( "transfer commandpool creation failed" );
+		}
+
+		memFac.setCommandPool( transferCommandpool );
+	}
+
+	//the frame's own buffers come from a pool per frame slot that is reset in one go
+	frameCommands = new CommandBufferAllocator( logicalDevice, queueIndices.graphics, framesInFlight );
 }
 
-void VulkanWindow::createCommandbuffers()
+//recorded right before submission, only safe once the fence of the frame slot has signaled
+VkCommandBuffer VulkanWindow::recordCommandbuffer( uint32_t frameIndex, uint32_t imageIndex )
 {
-	auto framebuffers = swapchain->getFrameBuffers();
-	commandBuffers.resize( framebuffers.size() );
+	frameCommands->beginFrame( frameIndex );
+	VkCommandBuffer cmdBuffer = frameCommands->allocate();
+
+	VkCommandBufferBeginInfo beginInfo = {};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	beginInfo.pInheritanceInfo = nullptr;
+
+	vkBeginCommandBuffer( cmdBuffer, &beginInfo );
+	gpuProfiler->beginFrame( cmdBuffer, frameIndex );
+
+	//scopes have to close before the command buffer ends
+	{
+		GpuScope frameScope( *gpuProfiler, cmdBuffer, "frame" );
+		recordMainPass( cmdBuffer, frameIndex, imageIndex );
+	}
+
+	if (vkEndCommandBuffer( cmdBuffer ) != VK_SUCCESS)
+	{
+		throw runtime_error( "command buffer recording failed" );
+	}
 
-	VkCommandBufferAllocateInfo allocInfo = {};
-	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-	allocInfo.commandPool = commandpool;
-	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-	allocInfo.commandBufferCount = (uint32_t)commandBuffers.size();
+	return cmdBuffer;
+}
 
-	if (vkAllocateCommandBuffers( logicalDevice, &allocInfo, commandBuffers.data() ) != VK_SUCCESS)
+void VulkanWindow::recordMainPass( VkCommandBuffer cmdBuffer, uint32_t frameIndex, uint32_t imageIndex )
+{
+	GpuScope passScope( *gpuProfiler, cmdBuffer, "main pass" );
+
+	VkCommandBufferInheritanceInfo inheritance = {};
+	inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+	inheritance.renderPass = graphicsPipeline->getRenderPass();
+	inheritance.subpass = 0;
+	inheritance.framebuffer = target->getFrameBuffers()[imageIndex];
+
+	//the secondaries are recorded before the pass begins, the primary only executes them
+	//a culled frame is a single draw call, there is nothing to split
+	uint32_t itemCount = static_cast<uint32_t>(drawQueue.getBatches().size());
+	if (drawMode == DrawMode::CULLED)
 	{
-		throw runtime_error( "command buffer allocation failed" );
+		itemCount = min( itemCount, 1u );
 	}
 
-	for (size_t i = 0; i < commandBuffers.size(); i++)
+	vector<VkCommandBuffer> secondaries = recorder->record( frameIndex, inheritance, itemCount,
+		[this, frameIndex]( VkCommandBuffer secondary, uint32_t first, uint32_t count ) { recordDraws( secondary, frameIndex, first, count ); } );
+
+	if (drawMode == DrawMode::INDIRECT)
 	{
-		VkCommandBufferBeginInfo beginInfo = {};
-		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
-		beginInfo.pInheritanceInfo = nullptr;
+		uploadIndirectCommands( cmdBuffer, frameIndex );
+	}
+	else if (drawMode == DrawMode::CULLED)
+	{
+		GpuScope cullScope( *gpuProfiler, cmdBuffer, "culling" );
+		culling->record( cmdBuffer, frameIndex );
+	}
 
-		vkBeginCommandBuffer( commandBuffers[i], &beginInfo );
-		vkCmdBindDescriptorSets( commandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, swapchain->getPipelineLayout(),
-			0, 1, &descriptorSet, 0, nullptr);
+	VkClearValue clearColor = { .0f, .0f, 0.0f, 1.0f };
+	VkRenderPassBeginInfo renderpassInfo = {};
+	renderpassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+	renderpassInfo.renderPass = graphicsPipeline->getRenderPass();
+	renderpassInfo.framebuffer = target->getFrameBuffers()[imageIndex];
+	renderpassInfo.renderArea.offset = { 0,0 };
+	renderpassInfo.renderArea.extent = target->getExtent();
+	renderpassInfo.clearValueCount = 1;
+	renderpassInfo.pClearValues = &clearColor;
+
+	vkCmdBeginRenderPass( cmdBuffer, &renderpassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS );
+	vkCmdExecuteCommands( cmdBuffer, static_cast<uint32_t>(secondaries.size()), secondaries.data() );
+	vkCmdEndRenderPass( cmdBuffer );
+}
 
-		VkClearValue clearColor = { .0f, .0f, 0.0f, 1.0f };
-		VkRenderPassBeginInfo renderpassInfo = {};
-		renderpassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-		renderpassInfo.renderPass = swapchain->getRenderPass();
-		renderpassInfo.framebuffer = framebuffers[i];
-		renderpassInfo.renderArea.offset = { 0,0 };
-		renderpassInfo.renderArea.extent = swapchain->getExtent();
-		renderpassInfo.clearValueCount = 1;
-		renderpassInfo.pClearValues = &clearColor;
+//runs on the recorder's threads, everything it touches must stay read only while recording
+//secondary buffers inherit nothing but the render pass, every one binds its own state
+void VulkanWindow::recordDraws( VkCommandBuffer cmdBuffer, uint32_t frameIndex, uint32_t first, uint32_t count )
+{
+	vkCmdBindPipeline( cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline->getPipeline() );
+
+	//one frame set for every frame slot, the dynamic offset picks the slot's region of the uniform buffer
+	VkDescriptorSet sets[] = { frameSet, materialSets[frameIndex] };
+	uint32_t uniformOffset = uniforms->getDynamicOffset( frameIndex );
+	vkCmdBindDescriptorSets( cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline->getPipelineLayout(),
+		0, 2, sets, 1, &uniformOffset );
+	vkCmdPushConstants( cmdBuffer, graphicsPipeline->getPipelineLayout(), DrawConstants::stages, 0, sizeof( DrawConstants ), &drawConstants );
+
+	VkViewport viewport = {};
+	viewport.x = 0.0f;
+	viewport.y = 0.0f;
+	viewport.width = (float)target->getExtent().width;
+	viewport.height = (float)target->getExtent().height;
+	viewport.minDepth = 0.0f;
+	viewport.maxDepth = 1.0f;
+
+	VkRect2D scissor = {};
+	scissor.offset = { 0, 0 };
+	scissor.extent = target->getExtent();
+
+	vkCmdSetViewport( cmdBuffer, 0, 1, &viewport );
+	vkCmdSetScissor( cmdBuffer, 0, 1, &scissor );
+
+	//culled frames read the surviving transforms the compute pass wrote
+	VkBuffer vertexBuffers[] = { geometry->getBuffer(), instances->getBuffer() };
+	VkDeviceSize  offsets[] = { 0, instances->getDynamicOffset( frameIndex ) };
+	if (drawMode == DrawMode::CULLED)
+	{
+		vertexBuffers[1] = culling->getVisibleBuffer();
+		offsets[1] = culling->getVisibleOffset( frameIndex );
+	}
+	vkCmdBindVertexBuffers( cmdBuffer, 0, 2, vertexBuffers, offsets );
+	vkCmdBindIndexBuffer( cmdBuffer, geometry->getBuffer(), geometry->getIndexOffset(), geometry->getIndexType() );
 
-		vkCmdBeginRenderPass( commandBuffers[i], &renderpassInfo, VK_SUBPASS_CONTENTS_INLINE );
-		vkCmdBindPipeline( commandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, swapchain->getPipeline() );
+	if (drawMode == DrawMode::CULLED)
+	{
+		culling->draw( cmdBuffer, frameIndex );
+		return;
+	}
 
-		VkBuffer vertexBuffers[] = { vertexBuffer };
-		VkDeviceSize  offsets[] = { 0 };
-		vkCmdBindVertexBuffers( commandBuffers[i], 0, 1, vertexBuffers, offsets );
-		vkCmdBindIndexBuffer( commandBuffers[i], indexBuffer, 0, VK_INDEX_TYPE_UINT16 );
+	if (drawMode == DrawMode::INDIRECT)
+	{
+		const VkDeviceSize stride = sizeof( VkDrawIndexedIndirectCommand );
+		VkDeviceSize offset = getIndirectOffset( frameIndex ) + first * stride;
 
-		vkCmdDrawIndexed( commandBuffers[i], static_cast<uint32_t>(indices.size()), 1, 0, 0, 0 );
-		vkCmdEndRenderPass( commandBuffers[i] );
+		if (deviceFeatures.multiDrawIndirect)
+		{
+			vkCmdDrawIndexedIndirect( cmdBuffer, indirectBuffer, offset, count, static_cast<uint32_t>(stride) );
+			return;
+		}
 
-		if (vkEndCommandBuffer( commandBuffers[i] ) != VK_SUCCESS)
+		//without multiDrawIndirect drawCount has to be 1, still one call per batch and not per object
+		for (uint32_t i = 0; i < count; i++)
 		{
-			throw runtime_error( "command buffer recording failed" );
+			vkCmdDrawIndexedIndirect( cmdBuffer, indirectBuffer, offset + i * stride, 1, static_cast<uint32_t>(stride) );
 		}
+		return;
+	}
+
+	const vector<DrawBatch>& batches = drawQueue.getBatches();
+
+	for (uint32_t i = first; i < first + count; i++)
+	{
+		const Mesh& mesh = geometry->getMeshes()[batches[i].mesh];
+		vkCmdDrawIndexed( cmdBuffer, mesh.indexCount, batches[i].instanceCount, mesh.firstIndex, mesh.vertexOffset, batches[i].firstInstance );
 	}
 }
 
 //TODO: look into a descriptor builder/factory
 //descriptorType is repeated 3 times, correlation between layout, pool, and write
-//need to account for creation order? descriptorSetLayout is needed when creating the swapchain (or earlier than the other parts at least)
+//need to account for creation order? the set layouts are needed when creating the pipeline (or earlier than the other parts at least)
 void VulkanWindow::createDescriptorSetLayout()
 {
-	descriptorSetLayout = DescriptorSetLayoutBuilder( logicalDevice )
-		.addBinding( 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr )
-		.addBinding( 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr )
+	frameSetLayout = DescriptorSetLayoutBuilder( logicalDevice )
+		.addBinding( 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr )
+		.build();
+
+	materialSetLayout = DescriptorSetLayoutBuilder( logicalDevice )
+		.addBinding( 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr )
 		.build();
 }
 
 void VulkanWindow::createDescriptorPool()
 {
 	descriptorPool = DescriptorPoolBuilder( logicalDevice )
-		.addPoolSize( VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1 )
-		.addPoolSize( VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1 )
+		.addPoolSize( VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1 )
+		.addPoolSize( VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, framesInFlight )
+		.setMaxSets( framesInFlight + 1 )
 		.build();
 }
 
-void VulkanWindow::createDescriptorSet()
+void VulkanWindow::createDescriptorSets()
 {
-	VkDescriptorSetLayout layouts[] = { descriptorSetLayout };
+	vector<VkDescriptorSetLayout> layouts( framesInFlight, materialSetLayout );
+	layouts.push_back( frameSetLayout );
+
+	vector<VkDescriptorSet> sets( framesInFlight + 1 );
+
 	VkDescriptorSetAllocateInfo allocInfo = {};
 	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
 	allocInfo.descriptorPool = descriptorPool;
-	allocInfo.descriptorSetCount = 1;
-	allocInfo.pSetLayouts = layouts;
+	allocInfo.descriptorSetCount = static_cast<uint32_t>(layouts.size());
+	allocInfo.pSetLayouts = layouts.data();
 
-	if (vkAllocateDescriptorSets( logicalDevice, &allocInfo, &descriptorSet ) != VK_SUCCESS)
+	if (vkAllocateDescriptorSets( logicalDevice, &allocInfo, sets.data() ) != VK_SUCCESS)
 	{
 		throw runtime_error( "couldn't create descriptorset" );
 	}
 
-	VkWriteDescriptorSet descriptorWrites[2] = { {},{} };
+	frameSet = sets.back();
+	materialSets.assign( sets.begin(), sets.begin() + framesInFlight );
+	materialVersions.resize( framesInFlight );
 
-	VkDescriptorBufferInfo bufferInfo = {};
-	bufferInfo.buffer = uniformBuffer;
-	bufferInfo.offset = 0;
-	bufferInfo.range = sizeof( UniformBufferObject );
-
-	descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	descriptorWrites[0].dstSet = descriptorSet;
-	descriptorWrites[0].dstBinding = 0;
-	descriptorWrites[0].dstArrayElement = 0;
-	descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	descriptorWrites[0].descriptorCount = 1;
-	descriptorWrites[0].pBufferInfo = &bufferInfo;
+	writeFrameSet();
 
-	VkDescriptorImageInfo imageInfo = {};
-	imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-	imageInfo.imageView = textureImageView;
-	imageInfo.sampler = textureSampler;
-
-	descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	descriptorWrites[1].dstSet = descriptorSet;
-	descriptorWrites[1].dstBinding = 1;
-	descriptorWrites[1].dstArrayElement = 0;
-	descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	descriptorWrites[1].descriptorCount = 1;
-	descriptorWrites[1].pImageInfo = &imageInfo;
-	
-	vkUpdateDescriptorSets( logicalDevice, 2, descriptorWrites, 0, nullptr );
+	for (uint32_t i = 0; i < framesInFlight; i++)
+	{
+		writeMaterialSet( materialSets[i] );
+		materialVersions[i] = textures->getVersion();
+	}
 }
 
-void VulkanWindow::createSemaphores()
+//only call once the fence of frameIndex has signaled, the set must not be in use when it is written
+void VulkanWindow::refreshMaterialSet( uint32_t frameIndex )
 {
-	VkSemaphoreCreateInfo spInfo = {};
-	spInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-
-	if (vkCreateSemaphore( logicalDevice, &spInfo, nullptr, &imageAvailableSemaphore ) != VK_SUCCESS
-		|| vkCreateSemaphore( logicalDevice, &spInfo, nullptr, &renderFinishedSemaphore ) != VK_SUCCESS)
+	if (materialVersions[frameIndex] != textures->getVersion())
 	{
-		throw runtime_error( "semaphore creation failed" );
+		writeMaterialSet( materialSets[frameIndex] );
+		materialVersions[frameIndex] = textures->getVersion();
 	}
 }
 
+void VulkanWindow::writeFrameSet()
+{
+	//offset 0, the frame's region is selected with the dynamic offset when binding
+	VkDescriptorBufferInfo bufferInfo = {};
+	bufferInfo.buffer = uniforms->getBuffer();
+	bufferInfo.offset = 0;
+	bufferInfo.range = uniforms->getRegionSize();
+
+	VkWriteDescriptorSet descriptorWrite = {};
+	descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	descriptorWrite.dstSet = frameSet;
+	descriptorWrite.dstBinding = 0;
+	descriptorWrite.dstArrayElement = 0;
+	descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+	descriptorWrite.descriptorCount = 1;
+	descriptorWrite.pBufferInfo = &bufferInfo;
+
+	vkUpdateDescriptorSets( logicalDevice, 1, &descriptorWrite, 0, nullptr );
+}
+
+void VulkanWindow::writeMaterialSet( VkDescriptorSet set )
+{
+	TextureBinding binding = textures->getBinding( texture );
+
+	VkDescriptorImageInfo imageInfo = {};
+	imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	imageInfo.imageView = binding.view;
+	imageInfo.sampler = binding.sampler;
+
+	VkWriteDescriptorSet descriptorWrite = {};
+	descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	descriptorWrite.dstSet = set;
+	descriptorWrite.dstBinding = 0;
+	descriptorWrite.dstArrayElement = 0;
+	descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descriptorWrite.descriptorCount = 1;
+	descriptorWrite.pImageInfo = &imageInfo;
+
+	vkUpdateDescriptorSets( logicalDevice, 1, &descriptorWrite, 0, nullptr );
+}
+
 //https://vulkan-tutorial.com/Uniform_buffers/Descriptor_pool_and_sets
-void VulkanWindow::update()
+void VulkanWindow::update( uint32_t frameIndex )
 {
-	timepoint now = chrono::high_resolution_clock::now();
+	timepoint now = chrono::steady_clock::now();
 
 	float time = chrono::duration<float, chrono::seconds::period>( now - startTime ).count() ;
 
+	//every quad spins around its own center, the same for all of them so it is pushed once per draw
+	drawConstants.model = glm::rotate( glm::mat4( 1.0f ), time * glm::radians( 90.0f ), glm::vec3( 0.0f, 0.0f, 1.0f ) );
+
 	UniformBufferObject ubo = {};
-	ubo.model = glm::rotate( glm::mat4( 1.0f ), time * glm::radians( 90.0f ), glm::vec3( 0.0f, 0.0f, 1.0f ) );
 	ubo.view = glm::lookAt( glm::vec3( 2.0f, 2.0f, 2.0f ), glm::vec3( 0.0f, 0.0f, 0.0f ), glm::vec3( 0.0f, 0.0f, 1.0f ) );
 	ubo.proj = glm::perspective( glm::radians( 45.0f ),
-		swapchain->getExtent().width / (float)swapchain->getExtent().height,
+		target->getExtent().width / (float)target->getExtent().height,
 		0.1f, 10.0f );
 
 	ubo.proj[1][1] *= -1;
+	viewProj = ubo.proj * ubo.view;
 
-	void* data;
-	vkMapMemory( logicalDevice, uniformMemory, 0, sizeof( ubo ) , 0, &data );
-	memcpy( data, &ubo, (size_t)sizeof(ubo) );
-	vkUnmapMemory( logicalDevice, uniformMemory );
+	uniforms->write( frameIndex, &ubo, sizeof( ubo ) );
 }
 
-void VulkanWindow::drawFrame()
+void VulkanWindow::updateInstances( uint32_t frameIndex )
 {
-	uint32_t imageIndex;
-	VkResult result = vkAcquireNextImageKHR( logicalDevice, swapchain->getSwapchain(), numeric_limits<uint64_t>::max(), imageAvailableSemaphore, VK_NULL_HANDLE, &imageIndex );
-	
-	if (result == VK_ERROR_OUT_OF_DATE_KHR)
+	drawQueue.clear();
+
+	//a grid around the origin, every quad scaled down to its cell
+	uint32_t side = static_cast<uint32_t>(ceil( sqrt( static_cast<double>(objectCount) ) ));
+	float cell = 2.0f / side;
+
+	for (uint32_t i = 0; i < objectCount; i++)
 	{
-		recreateSwapchain();
+		glm::vec3 center( -1.0f + cell * (i % side + 0.5f), -1.0f + cell * (i / side + 0.5f), 0.0f );
+		glm::mat4 model = glm::scale( glm::translate( glm::mat4( 1.0f ), center ), glm::vec3( 1.0f / side ) );
+
+		drawQueue.submit( 0, 0, model );
+	}
+
+	drawQueue.build();
+
+	//the culling pass uploads the objects itself, the gpu decides which instances are left
+	if (drawMode == DrawMode::CULLED)
+	{
+		culling->update( frameIndex, viewProj, drawQueue, geometry->getMeshes() );
 		return;
 	}
-	if( result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR )
+
+	const vector<InstanceData>& instanceData = drawQueue.getInstances();
+	instances->write( frameIndex, instanceData.data(), sizeof( InstanceData ) * instanceData.size() );
+
+	if (drawMode == DrawMode::INDIRECT)
+	{
+		drawQueue.writeIndirectCommands( geometry->getMeshes(), indirectCommands );
+		indirectStaging->write( frameIndex, indirectCommands.data(), sizeof( VkDrawIndexedIndirectCommand ) * indirectCommands.size() );
+	}
+}
+
+//the draw commands live in device local memory, the frame copies its own region in before drawing
+void VulkanWindow::uploadIndirectCommands( VkCommandBuffer cmdBuffer, uint32_t frameIndex )
+{
+	VkDeviceSize size = sizeof( VkDrawIndexedIndirectCommand ) * indirectCommands.size();
+
+	if (size == 0)
 	{
-		throw runtime_error( "error getting swapchain image" );
+		return;
 	}
 
-	VkSemaphore waitSemaphores[] = { imageAvailableSemaphore };
-	VkSemaphore signalSemaphores[] = { renderFinishedSemaphore };
+	GpuScope copyScope( *gpuProfiler, cmdBuffer, "indirect upload" );
+
+	VkBufferCopy copyRegion = {};
+	copyRegion.srcOffset = indirectStaging->getDynamicOffset( frameIndex );
+	copyRegion.dstOffset = getIndirectOffset( frameIndex );
+	copyRegion.size = size;
+	vkCmdCopyBuffer( cmdBuffer, indirectStaging->getBuffer(), indirectBuffer, 1, &copyRegion );
+
+	VkBufferMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.buffer = indirectBuffer;
+	barrier.offset = copyRegion.dstOffset;
+	barrier.size = size;
+
+	vkCmdPipelineBarrier( cmdBuffer,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+		0,
+		0, nullptr,
+		1, &barrier,
+		0, nullptr );
+}
+
+void VulkanWindow::drawFrame()
+{
+	CpuScope scope( "drawFrame" );
+
+	FrameSync& frame = frameScheduler->waitForFrame();
+	uint32_t frameIndex = frameScheduler->getFrameIndex();
+
+	//the offscreen target has an image per frame slot, the slot's fence already made it free
+	uint32_t imageIndex = frameIndex;
+
+	if (!headless)
+	{
+		destroyRetiredSwapchains();
+
+		if (resizePending && chrono::steady_clock::now() - lastResize >= resizeDebounce)
+		{
+			recreateSwapchain();
+		}
+
+		VkResult result;
+		{
+			CpuScope scope( "vkAcquireNextImageKHR" );
+			result = vkAcquireNextImageKHR( logicalDevice, swapchain->getSwapchain(), numeric_limits<uint64_t>::max(), frame.imageAvailable, VK_NULL_HANDLE, &imageIndex );
+		}
+
+		if (result == VK_ERROR_OUT_OF_DATE_KHR)
+		{
+			recreateSwapchain();
+			return;
+		}
+		if( result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR )
+		{
+			throw runtime_error( "error getting swapchain image" );
+		}
+	}
+
+	{
+		CpuScope scope( "update" );
+		textures->poll();
+		refreshMaterialSet( frameIndex );
+		update( frameIndex );
+		updateInstances( frameIndex );
+	}
+
+	VkCommandBuffer cmdBuffer;
+	{
+		CpuScope scope( "recordCommandbuffer" );
+		cmdBuffer = recordCommandbuffer( frameIndex, imageIndex );
+	}
+
+	VkSemaphore waitSemaphores[] = { frame.imageAvailable };
+	VkSemaphore signalSemaphores[] = { frame.renderFinished };
 	VkPipelineStageFlags waitstages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
 
 	VkSubmitInfo submitInfo = {};
@@ -200,13 +444,30 @@ void VulkanWindow::drawFrame()
 	submitInfo.pWaitSemaphores = waitSemaphores;
 	submitInfo.pWaitDstStageMask = waitstages;
 	submitInfo.commandBufferCount = 1;
-	submitInfo.pCommandBuffers = &commandBuffers[imageIndex];
+	submitInfo.pCommandBuffers = &cmdBuffer;
 	submitInfo.signalSemaphoreCount = 1;
 	submitInfo.pSignalSemaphores = signalSemaphores;
 
-	if (vkQueueSubmit( graphicsQ, 1, &submitInfo, VK_NULL_HANDLE ) != VK_SUCCESS)
+	//no acquire to wait for and no present to signal, the frame fence is all the sync there is
+	if (headless)
+	{
+		submitInfo.waitSemaphoreCount = 0;
+		submitInfo.signalSemaphoreCount = 0;
+	}
+
+	{
+		CpuScope scope( "vkQueueSubmit" );
+
+		if (vkQueueSubmit( graphicsQ, 1, &submitInfo, frameScheduler->resetFence() ) != VK_SUCCESS)
+		{
+			throw runtime_error( "draw submission failed" );
+		}
+	}
+
+	if (headless)
 	{
-		throw runtime_error( "draw submission failed" );
+		frameScheduler->advance();
+		return;
 	}
 
 	VkSwapchainKHR swapchains[] = { swapchain->getSwapchain() };
@@ -220,16 +481,20 @@ void VulkanWindow::drawFrame()
 	presentInfo.pImageIndices = &imageIndex;
 	presentInfo.pResults = nullptr;
 
-	result = vkQueuePresentKHR( presentQ, &presentInfo );
+	VkResult result;
+	{
+		CpuScope scope( "vkQueuePresentKHR" );
+		result = vkQueuePresentKHR( presentQ, &presentInfo );
+	}
+	frameScheduler->advance();
 
-	if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
+	//a suboptimal swapchain still presents fine, while resizing the debounce decides when to replace it
+	if (result == VK_ERROR_OUT_OF_DATE_KHR || (result == VK_SUBOPTIMAL_KHR && !resizePending))
 	{
 		recreateSwapchain();
 	}
-	else if (result != VK_SUCCESS)
+	else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
 	{
 		throw std::runtime_error( "failed to present swap chain image!" );
 	}
-
-	vkQueueWaitIdle( presentQ );
 }
\ No newline at end of file
@@ -3,12 +3,9 @@
 using namespace com::gelunox::vulcanUtils;
 using namespace std;
 
+//only the placeholder is uploaded here, decoding the real image doesn't hold up the construction
 void VulkanWindow::createImage()
 {
-	memFac.createTextureImage( "textures/chibi.png", textureImage, textureImageMemory );
-	textureImageView = ImageViewBuilder( logicalDevice )
-		.setFormat( VK_FORMAT_R8G8B8A8_UNORM )
-		.setImage( textureImage )
-		.build();
-	textureSampler = SamplerBuilder( logicalDevice ).build();
+	textures = new TextureStreamer( logicalDevice, memFac, *assets, deviceFeatures.samplerAnisotropy );
+	texture = textures->request( "textures/chibi.png" );
 }
\ No newline at end of file
@@ -1,14 +1,10 @@
 #include "VulkanWindow.hpp"
 
-#define GLM_FORCE_RADIANS
-#define GLM_FORCE_DEPTH_ZERO_TO_ONE
-
 #include "util/Util.hpp"
 
 #include <glm/vec4.hpp>
 #include <glm/mat4x4.hpp>
 
-#include <thread>
 #include <set>
 #include <algorithm>
 #include <iostream>
@@ -77,28 +73,38 @@ bool VulkanWindow::isSuitableGpu( VkPhysicalDevice device )
 }
 
 //https://vulkan-tutorial.com/Drawing_a_triangle/Setup/Instance
-VulkanWindow::VulkanWindow()
+VulkanWindow::VulkanWindow( uint32_t framesInFlight, bool headless, bool reportStats )
+	: framesInFlight( framesInFlight ), headless( headless ), enableValidationLayers( !headless ), reportStats( reportStats )
 {
-	//GLFW init
-	glfwInit();
-
-	glfwWindowHint( GLFW_CLIENT_API, GLFW_NO_API );
-	window = glfwCreateWindow( width, height, "Vulkan window", nullptr, nullptr );
-
-	glfwSetWindowUserPointer( window, this );
-	glfwSetWindowSizeCallback( window, VulkanWindow::onWindowResized );
-
-	uint32_t glfwExtensionCount = 0;
-	const char** glfwExtensions;
-	glfwExtensions = glfwGetRequiredInstanceExtensions( &glfwExtensionCount );
-
 	//Vulkan init
 	InstanceBuilder builder = InstanceBuilder()
 		.setApplicationName( "Hello Triangle" )
 		.setEngineName( "White Dragon" )
-		.addExtensions( vector<const char*>( glfwExtensions, glfwExtensions + glfwExtensionCount ) )
 		.setValidationLayersEnabled( enableValidationLayers );
 
+	//a window is paced by its present mode, FIFO already waits for vblank and a second cadence on top would drift against it
+	//headless has nothing to pace to, a benchmark renders as fast as the device allows; main sets TARGET_FPS when asked for
+	pacer.setMode( PacingMode::UNCAPPED, 0.0 );
+
+	if (!headless)
+	{
+		//GLFW init
+		glfwInit();
+
+		glfwWindowHint( GLFW_CLIENT_API, GLFW_NO_API );
+		window = glfwCreateWindow( width, height, "Vulkan window", nullptr, nullptr );
+
+		glfwSetWindowUserPointer( window, this );
+		glfwSetWindowSizeCallback( window, VulkanWindow::onWindowResized );
+		glfwSetKeyCallback( window, VulkanWindow::onKey );
+
+		uint32_t glfwExtensionCount = 0;
+		const char** glfwExtensions;
+		glfwExtensions = glfwGetRequiredInstanceExtensions( &glfwExtensionCount );
+
+		builder.addExtensions( vector<const char*>( glfwExtensions, glfwExtensions + glfwExtensionCount ) );
+	}
+
 	if (enableValidationLayers)
 	{
 		builder.addExtension( VK_EXT_DEBUG_REPORT_EXTENSION_NAME );
@@ -106,15 +112,18 @@ VulkanWindow::VulkanWindow()
 
 	instance = builder.build();
 
-	VkDebugReportCallbackCreateInfoEXT debugInfo = {};
-	debugInfo.sType = VK_STRUCTURE_TYPE_DEBUG_REPORT_CALLBACK_CREATE_INFO_EXT;
-	debugInfo.flags = VK_DEBUG_REPORT_ERROR_BIT_EXT | VK_DEBUG_REPORT_WARNING_BIT_EXT;
-	debugInfo.pfnCallback = debugCallback;
+	if (enableValidationLayers)
+	{
+		VkDebugReportCallbackCreateInfoEXT debugInfo = {};
+		debugInfo.sType = VK_STRUCTURE_TYPE_DEBUG_REPORT_CALLBACK_CREATE_INFO_EXT;
+		debugInfo.flags = VK_DEBUG_REPORT_ERROR_BIT_EXT | VK_DEBUG_REPORT_WARNING_BIT_EXT;
+		debugInfo.pfnCallback = debugCallback;
 
-	CreateDebugReportCallbackEXT( instance, &debugInfo, nullptr, &callback );
+		CreateDebugReportCallbackEXT( instance, &debugInfo, nullptr, &callback );
+	}
 	
 	//Window surface
-	if (glfwCreateWindowSurface( instance, window, nullptr, &surface ) != VK_SUCCESS)
+	if (!headless && glfwCreateWindowSurface( instance, window, nullptr, &surface ) != VK_SUCCESS)
 	{
 		throw runtime_error( "could not create window surface" );
 	}
@@ -125,63 +134,163 @@ VulkanWindow::VulkanWindow()
 
 	createDescriptorSetLayout();
 
-	swapchain = new Swapchain( width, height, physicalDevice, logicalDevice, surface, queueIndices, descriptorSetLayout );
+	//shaders and textures come from the pack when it was built with --pack-assets, loose files otherwise
+	assets = new AssetLoader( "assets.pack" );
+	pipelineCache = new PipelineCache( physicalDevice, logicalDevice );
+
+	if (headless)
+	{
+		VkExtent2D extent = { static_cast<uint32_t>(width), static_cast<uint32_t>(height) };
+		offscreen = new OffscreenTarget( logicalDevice, allocator, extent, VK_FORMAT_B8G8R8A8_UNORM, framesInFlight );
+		target = offscreen;
+
+		//never presented, leave the image ready to be copied out instead
+		graphicsPipeline = new GraphicsPipeline( logicalDevice, *assets, frameSetLayout, materialSetLayout, pipelineCache->getCache(), offscreen->getImageFormat(),
+			VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL );
+	}
+	else
+	{
+		swapchain = new Swapchain( width, height, physicalDevice, logicalDevice, surface, queueIndices );
+		target = swapchain;
+
+		graphicsPipeline = new GraphicsPipeline( logicalDevice, *assets, frameSetLayout, materialSetLayout, pipelineCache->getCache(),
+			swapchain->getImageFormat() );
+	}
+
+	target->createFrameBuffers( graphicsPipeline->getRenderPass() );
 
 	createCommandpool();
+
+	//all initial uploads go out in one submit, nothing waits on them until the first frame
+	memFac.beginBatch();
 	createBuffers();
 	createImage();
+	initialUploads = memFac.submitBatch();
 
 	createDescriptorPool();
-	createDescriptorSet();
+	createDescriptorSets();
 
-	createCommandbuffers();
-	createSemaphores();
+	if (queueIndices.compute >= 0 && deviceFeatures.multiDrawIndirect && deviceFeatures.drawIndirectFirstInstance)
+	{
+		culling = new CullingPass( physicalDevice, logicalDevice, allocator, memFac, *assets, pipelineCache->getCache(),
+			framesInFlight, maxInstances, maxBatches, drawIndirectCountSupported );
+	}
+	setDrawMode( drawMode );
+
+	recorder = new ParallelRecorder( logicalDevice, queueIndices.graphics, framesInFlight );
+	frameScheduler = new FrameScheduler( logicalDevice, framesInFlight );
+	gpuProfiler = new GpuProfiler( physicalDevice, logicalDevice, queueIndices.graphics, framesInFlight );
 }
 
 VulkanWindow::~VulkanWindow()
 {
 	vkDeviceWaitIdle( logicalDevice );
 
-	vkDestroySemaphore( logicalDevice, imageAvailableSemaphore, nullptr );
-	vkDestroySemaphore( logicalDevice, renderFinishedSemaphore, nullptr );
+	if (reportStats)
+	{
+		pacer.report( cout );
+		gpuProfiler->report( cout );
 
-	vkDestroyDescriptorSetLayout( logicalDevice, descriptorSetLayout, nullptr );
+		frameCommands->getTotalStats().report( cout, "frame", &frameCommands->getLastFrameStats() );
+		CommandBufferStats recordedLastFrame = recorder->getLastFrameStats();
+		recorder->getTotalStats().report( cout, "recorded", &recordedLastFrame );
+	}
+	delete gpuProfiler;
+	delete frameScheduler;
+	delete frameCommands;
+	delete recorder;
+
+	vkDestroyDescriptorSetLayout( logicalDevice, frameSetLayout, nullptr );
+	vkDestroyDescriptorSetLayout( logicalDevice, materialSetLayout, nullptr );
 	vkDestroyDescriptorPool( logicalDevice, descriptorPool, nullptr );
 
 	delete swapchain;
+	delete offscreen;
+	for (RetiredSwapchain& retired : retiredSwapchains)
+	{
+		delete retired.swapchain;
+	}
+	delete graphicsPipeline;
+	delete pipelineCache;
 
-	vkDestroyBuffer( logicalDevice, indexBuffer, nullptr );
-	vkFreeMemory( logicalDevice, indexMemory, nullptr );
+	if (reportStats)
+	{
+		allocator->report( cout );
+	}
 
-	vkDestroyBuffer( logicalDevice, vertexBuffer, nullptr );
-	vkFreeMemory( logicalDevice, vertexMemory, nullptr );
+	delete geometry;
 
-	vkDestroyBuffer( logicalDevice, uniformBuffer, nullptr );
-	vkFreeMemory( logicalDevice, uniformMemory, nullptr );
+	delete uniforms;
+	delete instances;
+	delete indirectStaging;
+	memFac.destroyBuffer( indirectBuffer, indirectMemory );
+	delete culling;
 	
-	vkDestroyImageView( logicalDevice, textureImageView, nullptr );
-	vkDestroyImage( logicalDevice, textureImage, nullptr );
-	vkFreeMemory( logicalDevice, textureImageMemory, nullptr );
-	vkDestroySampler( logicalDevice, textureSampler, nullptr );
+	delete textures;
+	//the shaders and textures above may have been views into its mapping
+	delete assets;
 
+	memFac.releaseUploadResources();
+	if (reportStats)
+	{
+		//uploads aren't tied to frames, only the totals mean anything
+		memFac.getCommandBufferStats().report( cout, "upload" );
+	}
 	vkDestroyCommandPool( logicalDevice, commandpool, nullptr );
+	if (transferCommandpool != VK_NULL_HANDLE)
+	{
+		vkDestroyCommandPool( logicalDevice, transferCommandpool, nullptr );
+	}
 
+	delete stagingRing;
+	delete allocator;
 	vkDestroyDevice( logicalDevice, nullptr );
+
+	if (enableValidationLayers)
+	{
+		DestroyDebugReportCallbackEXT( instance, callback, nullptr );
+	}
+
+	if (headless)
+	{
+		vkDestroyInstance( instance, nullptr );
+		return;
+	}
+
 	vkDestroySurfaceKHR( instance, surface, nullptr );
-	DestroyDebugReportCallbackEXT( instance, callback, nullptr );
 	vkDestroyInstance( instance, nullptr );
 	glfwDestroyWindow( window );
 	glfwTerminate();
 }
 
-void VulkanWindow::run()
+void VulkanWindow::run( uint32_t frameCount )
 {
-	while (!glfwWindowShouldClose( window ))
+	memFac.wait( initialUploads );
+	pacer.setRecordFrameTimes( frameCount > 0 );
+
+	for (uint32_t frames = 0; frameCount == 0 || frames < frameCount; frames++)
 	{
-		glfwPollEvents();
-		update();
+		if (!headless && glfwWindowShouldClose( window ))
+		{
+			break;
+		}
+
+		pacer.beginFrame();
+		//block on the gpu before sampling input, drawFrame's own wait then returns immediately
+		{
+			CpuScope scope( "waitForFrame" );
+			frameScheduler->waitForFrame();
+		}
+		pacer.waitForInputSample();
+
+		if (!headless)
+		{
+			CpuScope scope( "glfwPollEvents" );
+			glfwPollEvents();
+		}
 		drawFrame();
-		this_thread::sleep_for( chrono::milliseconds( 10 ) );
+
+		pacer.endFrame();
 	}
 }
 
@@ -195,7 +304,8 @@ void VulkanWindow::onWindowResized( int width, int height )
 	this->width = width;
 	this->height = height;
 
-	recreateSwapchain();
+	resizePending = true;
+	lastResize = chrono::steady_clock::now();
 }
 
 void VulkanWindow::onWindowResized( GLFWwindow * window, int width, int height )
@@ -204,6 +314,15 @@ void VulkanWindow::onWindowResized( GLFWwindow * window, int width, int height )
 	app->onWindowResized( width, height );
 }
 
+void VulkanWindow::onKey( GLFWwindow *, int key, int, int action, int )
+{
+	if (key == GLFW_KEY_F12 && action == GLFW_PRESS && CpuProfiler::isEnabled())
+	{
+		CpuProfiler::writeChromeTrace( "trace.json" );
+		cout << "cpu trace written to trace.json" << endl;
+	}
+}
+
 //https://vulkan-tutorial.com/Drawing_a_triangle/Setup/Physical_devices_and_queue_families
 //retrieve graphics query and presentation query
 void VulkanWindow::findQFamilyIndexes()
@@ -215,19 +334,59 @@ void VulkanWindow::findQFamilyIndexes()
 	vector<VkQueueFamilyProperties> queueFamilies( queueFamilyCount );
 	vkGetPhysicalDeviceQueueFamilyProperties( physicalDevice, &queueFamilyCount, queueFamilies.data() );
 
+	//a transfer-only family is usually a dedicated dma engine, a compute family without graphics is the next best thing
+	for (uint32_t family = 0; family < queueFamilyCount; family++)
+	{
+		VkQueueFlags flags = queueFamilies[family].queueFlags;
+
+		if (queueFamilies[family].queueCount == 0 || flags & VK_QUEUE_GRAPHICS_BIT)
+		{
+			continue;
+		}
+
+		//a zero granularity only copies whole levels at once, a level larger than the staging ring could never be uploaded
+		if (queueFamilies[family].minImageTransferGranularity.height == 0)
+		{
+			continue;
+		}
+
+		//compute queues support transfers without advertising it
+		if (flags & VK_QUEUE_COMPUTE_BIT)
+		{
+			if (queueIndices.transfer < 0)
+			{
+				queueIndices.transfer = family;
+			}
+		}
+		else if (flags & VK_QUEUE_TRANSFER_BIT)
+		{
+			queueIndices.transfer = family;
+			break;
+		}
+	}
+
 	int i = 0; //example retrieves last queue?
 	for (auto& queueFamily : queueFamilies)
 	{
 		if (queueFamily.queueCount > 0 && queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)
 		{
 			queueIndices.graphics = i;
+			queueIndices.compute = queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT ? i : -1;
 		}
 
-		VkBool32 presentationSupport = false;
-		vkGetPhysicalDeviceSurfaceSupportKHR( physicalDevice, i, surface, &presentationSupport );
-		if (presentationSupport)
+		//without a surface nothing is presented, the graphics family stands in to keep the indices complete
+		if (headless)
 		{
-			queueIndices.presentation = i;
+			queueIndices.presentation = queueIndices.graphics;
+		}
+		else
+		{
+			VkBool32 presentationSupport = false;
+			vkGetPhysicalDeviceSurfaceSupportKHR( physicalDevice, i, surface, &presentationSupport );
+			if (presentationSupport)
+			{
+				queueIndices.presentation = i;
+			}
 		}
 
 		if ( queueIndices.isComplete() )
@@ -239,25 +398,70 @@ void VulkanWindow::findQFamilyIndexes()
 	}
 }
 
+//no device drain, frames in flight keep using the old swapchain until it is retired
 void VulkanWindow::recreateSwapchain()
 {
+	CpuScope scope( "recreateSwapchain" );
+	resizePending = false;
+
 	Swapchain * old = swapchain;
+	swapchain = new Swapchain( width, height, physicalDevice, logicalDevice, surface, queueIndices, old );
+	target = swapchain;
+	retiredSwapchains.push_back( { old, frameScheduler->getFrameNumber() } );
 
-	vkDeviceWaitIdle( logicalDevice );
-	swapchain = new Swapchain( width, height, physicalDevice, logicalDevice, surface, queueIndices, descriptorSetLayout, old );
-	vkFreeCommandBuffers( logicalDevice, commandpool, static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data() );
-	createCommandbuffers();
-	delete old;
+	//only a format change needs a new render pass and pipeline, the extent is dynamic state
+	if (swapchain->getImageFormat() != graphicsPipeline->getImageFormat())
+	{
+		//rare enough to simply drain for, in flight frames still use the old render pass
+		vkDeviceWaitIdle( logicalDevice );
+		graphicsPipeline->setImageFormat( swapchain->getImageFormat() );
+	}
+
+	swapchain->createFrameBuffers( graphicsPipeline->getRenderPass() );
+}
+
+void VulkanWindow::destroyRetiredSwapchains()
+{
+	while (!retiredSwapchains.empty() && retiredSwapchains.front().usedUntilFrame <= frameScheduler->getCompletedFrames())
+	{
+		delete retiredSwapchains.front().swapchain;
+		retiredSwapchains.pop_front();
+	}
 }
 
 void VulkanWindow::createBuffers()
 {
-	memFac.createBufferMemory( sizeof( vertices[0] ) * vertices.size(), vertices.data(), vertexBuffer, vertexMemory, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT );
-	memFac.createBufferMemory( sizeof( indices[0] ) *  indices.size(), indices.data(), indexBuffer, indexMemory, VK_BUFFER_USAGE_INDEX_BUFFER_BIT );
-
-	//uniformbuffer
-	memFac.createBuffer( sizeof( UniformBufferObject ),
-		VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-		uniformBuffer, uniformMemory );
+	//the file's vertices and indices are copied to staging as they are, it isn't needed after this
+	//the mesh cooked with --cook-mesh is the whole scene, the arena is sized for exactly that
+	MeshFile scene( assets->load( "models/quad.mesh" ), "models/quad.mesh" );
+
+	geometry = new GeometryArena( memFac, scene.getVertexCount(), scene.getIndexCount(), scene.getMaxMeshVertexCount() );
+	geometry->add( scene );
+
+	uniforms = new FrameUniformBuffer( physicalDevice, logicalDevice, allocator, sizeof( UniformBufferObject ), framesInFlight );
+
+	instances = new FrameUniformBuffer( physicalDevice, logicalDevice, allocator, sizeof( InstanceData ) * maxInstances, framesInFlight,
+		VK_BUFFER_USAGE_VERTEX_BUFFER_BIT );
+	indirectStaging = new FrameUniformBuffer( physicalDevice, logicalDevice, allocator, sizeof( VkDrawIndexedIndirectCommand ) * maxBatches, framesInFlight,
+		VK_BUFFER_USAGE_TRANSFER_SRC_BIT );
+
+	memFac.createBuffer( sizeof( VkDrawIndexedIndirectCommand ) * maxBatches * framesInFlight,
+		VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+		indirectBuffer, indirectMemory );
+}
+
+void VulkanWindow::setDrawMode( DrawMode mode )
+{
+	if (mode == DrawMode::CULLED && culling == nullptr)
+	{
+		mode = DrawMode::INDIRECT;
+	}
+
+	drawMode = mode == DrawMode::INDIRECT && !deviceFeatures.drawIndirectFirstInstance ? DrawMode::INSTANCED : mode;
+}
+
+void VulkanWindow::setObjectCount( uint32_t count )
+{
+	objectCount = min( max( count, 1u ), maxInstances );
 }
\ No newline at end of file
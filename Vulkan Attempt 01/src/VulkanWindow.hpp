@@ -1,12 +1,15 @@
 #pragma once
 
 #define GLFW_INCLUDE_VULKAN
+#ifdef _WIN32
 #define VK_USE_PLATFORM_WIN32_KHR
+#endif
 
 #include <chrono>
 
 #include <GLFW/glfw3.h>
 #include <vector>
+#include <deque>
 #include <glm/vec4.hpp>
 #include <glm/mat4x4.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -14,12 +17,29 @@
 #include "util/Util.hpp"
 #include "Vertex.hpp"
 #include "UniformBufferObject.hpp"
+#include "DrawConstants.hpp"
 #include "QueueIndices.hpp"
 #include "Swapchain.hpp"
+#include "OffscreenTarget.hpp"
+#include "FrameScheduler.hpp"
+#include "FramePacer.hpp"
+#include "ParallelRecorder.hpp"
+#include "DrawQueue.hpp"
+#include "CullingPass.hpp"
+#include "CommandBufferAllocator.hpp"
+#include "PipelineCache.hpp"
+#include "GraphicsPipeline.hpp"
+#include "profiling/GpuProfiler.hpp"
+#include "profiling/CpuProfiler.hpp"
+#include "texture/TextureStreamer.hpp"
+#include "asset/AssetLoader.hpp"
+#include "mesh/MeshFile.hpp"
 
 #include "builder/InstanceBuilder.hpp"
 #include "builder/LogicalDeviceBuilder.hpp"
 #include "builder/MemoryFactory.hpp"
+#include "memory/FrameUniformBuffer.hpp"
+#include "memory/GeometryArena.hpp"
 #include "builder/ImageViewBuilder.hpp"
 #include "builder/SamplerBuilder.hpp"
 #include "builder/DescriptorSetLayoutBuilder.hpp"
@@ -36,9 +56,15 @@ namespace com::gelunox::vulcanUtils
 	private:
 		int width = 500;
 		int height = 500;
-		timepoint startTime = chrono::high_resolution_clock::now();
-
-		const bool enableValidationLayers = true;
+		const uint32_t framesInFlight;
+		timepoint startTime = chrono::steady_clock::now();
+
+		//no window, surface or swapchain, frames render into an OffscreenTarget
+		const bool headless;
+		//off when headless, benchmark machines often lack the layers and they would skew the timings
+		const bool enableValidationLayers;
+		//prints the pacing, gpu, memory and queue reports, a normal windowed run stays quiet
+		const bool reportStats;
 		VkDebugReportCallbackEXT callback;
 
 		const vector<const char*> deviceExtensions =
@@ -46,66 +72,115 @@ namespace com::gelunox::vulcanUtils
 			VK_KHR_SWAPCHAIN_EXTENSION_NAME
 		};
 
-		GLFWwindow * window;
+		GLFWwindow * window = nullptr;
 
 		VkInstance instance;
 		VkPhysicalDevice physicalDevice;
+		VkPhysicalDeviceFeatures deviceFeatures;
 		VkDevice logicalDevice;
-		VkSurfaceKHR surface;
+		VkSurfaceKHR surface = VK_NULL_HANDLE;
 
 		VkQueue graphicsQ;
 		VkQueue presentQ;
+		//same queue as graphicsQ when the device has no dedicated transfer family
+		VkQueue transferQ;
+
+		//whichever of swapchain and offscreen is in use
+		RenderTarget * target;
+		Swapchain * swapchain = nullptr;
+		OffscreenTarget * offscreen = nullptr;
+		//replaced swapchains, destroyed once every frame submitted before the replacement has finished
+		struct RetiredSwapchain
+		{
+			Swapchain * swapchain;
+			uint64_t usedUntilFrame;
+		};
+		deque<RetiredSwapchain> retiredSwapchains;
 
-		Swapchain * swapchain;
+		//resize events only mark the swapchain stale, it is recreated once they stop for a moment
+		bool resizePending = false;
+		timepoint lastResize;
+		const chrono::milliseconds resizeDebounce = chrono::milliseconds( 100 );
+		AssetLoader * assets;
+		PipelineCache * pipelineCache;
+		GraphicsPipeline * graphicsPipeline;
 
-		//it would better to have a single buffer with offsets
-		VkBuffer vertexBuffer;
-		VkDeviceMemory vertexMemory;
-		VkBuffer indexBuffer;
-		VkDeviceMemory indexMemory;
-		VkBuffer uniformBuffer;
-		VkDeviceMemory uniformMemory;
+		//vertices and indices of every mesh, bound once per commandbuffer
+		GeometryArena * geometry;
+		//one region per frame-in-flight, the cpu must not overwrite one the gpu still reads
+		FrameUniformBuffer * uniforms;
 
-		VkImage textureImage;
-		VkDeviceMemory textureImageMemory;
-		VkImageView textureImageView;
-		VkSampler textureSampler;
+		//chibi.png is decoded in the background, the placeholder is drawn until it is resident
+		TextureStreamer * textures;
+		uint32_t texture;
 
 		VkDescriptorPool descriptorPool;
-		VkDescriptorSetLayout descriptorSetLayout;
-		VkDescriptorSet descriptorSet;
+		//set 0, a single set for view and proj written once, its uniform binding is dynamic and bound with the frame's offset
+		VkDescriptorSetLayout frameSetLayout;
+		VkDescriptorSet frameSet;
+		//set 1, a set per frame slot, a streamed texture can only be written into a set no frame in flight uses
+		VkDescriptorSetLayout materialSetLayout;
+		vector<VkDescriptorSet> materialSets;
+		//the streamer version each set was written with
+		vector<uint64_t> materialVersions;
+		//pushed by every secondary before it draws, written by update before recording starts
+		DrawConstants drawConstants;
 
 		VkCommandPool commandpool;
-		vector<VkCommandBuffer> commandBuffers;
-		VkSemaphore imageAvailableSemaphore;
-		VkSemaphore renderFinishedSemaphore;
+		VkCommandPool transferCommandpool = VK_NULL_HANDLE;
+		CommandBufferAllocator * frameCommands;
+		ParallelRecorder * recorder;
+		FrameScheduler * frameScheduler;
+		FramePacer pacer;
+		GpuProfiler * gpuProfiler;
 
 		QueueIndices queueIndices;
+		MemoryAllocator * allocator;
+		StagingRing * stagingRing;
 		MemoryFactory memFac;
+		UploadTicket initialUploads;
 
-		const vector<Vertex> vertices =
-		{
-			{ { -0.8f, -0.8f }, { 1.0f, 0.0f, 0.0f }, { 1.0f, 0.0f } },
-			{ {  0.8f, -0.8f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f } },
-			{ {  0.8f,  0.8f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 1.0f } },
-			{ { -0.8f,  0.8f }, { 0.5f, 0.0f, 0.5f }, { 1.0f, 1.0f } }
-		};
-		const vector<uint16_t> indices =
-		{
-			0, 1, 2,
-			2, 3, 0
-		};
+
+		//the scene is a grid of objectCount quads, a single one fills the whole grid
+		uint32_t objectCount = 1;
+		DrawQueue drawQueue;
+		DrawMode drawMode = DrawMode::CULLED;
+
+		//capacity of the per frame regions
+		const uint32_t maxInstances = 65536;
+		const uint32_t maxBatches = 4096;
+		FrameUniformBuffer * instances;
+		//written by the cpu, copied into indirectBuffer by the frame's own command buffer
+		FrameUniformBuffer * indirectStaging;
+		VkBuffer indirectBuffer;
+		Allocation indirectMemory;
+		vector<VkDrawIndexedIndirectCommand> indirectCommands;
+
+		//only created when the device can run it, see setDrawMode
+		CullingPass * culling = nullptr;
+		bool drawIndirectCountSupported = false;
+		glm::mat4 viewProj;
 
 	public:
 		static bool isSuitableGpu( VkPhysicalDevice device );
 
-		VulkanWindow();
+		VulkanWindow( uint32_t framesInFlight = 2, bool headless = false, bool reportStats = false );
 		~VulkanWindow();
 
-		void run();
+		//renders until the window closes, or frameCount frames when it isn't 0
+		//a fixed frame count is a benchmark, the pacer then keeps every frame time for its report
+		void run( uint32_t frameCount = 0 );
+		FramePacer& getFramePacer() { return pacer; }
+
+		//CULLED falls back to INDIRECT without compute on the graphics queue or multiDrawIndirect
+		//INDIRECT falls back to INSTANCED when the device lacks drawIndirectFirstInstance
+		void setDrawMode( DrawMode mode );
+		void setObjectCount( uint32_t count );
 
 		void onWindowResized( int width, int height );
 		static void onWindowResized( GLFWwindow * window, int width, int height );
+		//F12 writes the cpu trace recorded so far to trace.json
+		static void onKey( GLFWwindow * window, int key, int scancode, int action, int mods );
 
 	private:
 		void selectPhysicalDevice();
@@ -113,6 +188,7 @@ namespace com::gelunox::vulcanUtils
 		void findQFamilyIndexes();
 
 		void recreateSwapchain();
+		void destroyRetiredSwapchains();
 
 		void createCommandpool();
 
@@ -121,12 +197,20 @@ namespace com::gelunox::vulcanUtils
 
 		void createDescriptorSetLayout();
 		void createDescriptorPool();
-		void createDescriptorSet();
-
-		void createCommandbuffers();
-		void createSemaphores();
-
-		void update();
+		void createDescriptorSets();
+		void writeFrameSet();
+		void writeMaterialSet( VkDescriptorSet set );
+		//rewrites the frame's material set when a texture became resident since it was last written
+		void refreshMaterialSet( uint32_t frameIndex );
+
+		VkCommandBuffer recordCommandbuffer( uint32_t frameIndex, uint32_t imageIndex );
+		void recordMainPass( VkCommandBuffer cmdBuffer, uint32_t frameIndex, uint32_t imageIndex );
+		void recordDraws( VkCommandBuffer cmdBuffer, uint32_t frameIndex, uint32_t first, uint32_t count );
+
+		void update( uint32_t frameIndex );
+		void updateInstances( uint32_t frameIndex );
+		VkDeviceSize getIndirectOffset( uint32_t frameIndex ) { return frameIndex * maxBatches * sizeof( VkDrawIndexedIndirectCommand ); }
+		void uploadIndirectCommands( VkCommandBuffer cmdBuffer, uint32_t frameIndex );
 		void drawFrame();
 	};
 }
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+using namespace std;
+
+namespace com::gelunox::vulcanUtils
+{
+	//the bytes of an asset, either a view into a mapped AssetPack or a buffer of its own
+	//a view is only valid while its pack is open, moving keeps the bytes where they are either way
+	class AssetData
+	{
+	private:
+		const char * bytes = nullptr;
+		size_t length = 0;
+		vector<char> storage;
+
+	public:
+		AssetData() = default;
+		AssetData( const char * bytes, size_t length ) : bytes( bytes ), length( length ) {}
+		explicit AssetData( vector<char>&& storage ) : storage( move( storage ) )
+		{
+			bytes = this->storage.data();
+			length = this->storage.size();
+		}
+
+		AssetData( AssetData&& ) = default;
+		AssetData& operator=( AssetData&& ) = default;
+		AssetData( const AssetData& ) = delete;
+		AssetData& operator=( const AssetData& ) = delete;
+
+		const char * data() const { return bytes; }
+		size_t size() const { return length; }
+		bool isView() const { return storage.empty() && bytes != nullptr; }
+	};
+}
@@ -0,0 +1,31 @@
+#include "AssetLoader.hpp"
+
+#include <fstream>
+
+#include "../util/Util.hpp"
+
+using namespace com::gelunox::vulcanUtils;
+using namespace std;
+
+AssetLoader::AssetLoader( const string& packPath )
+{
+	if (ifstream( packPath ).good())
+	{
+		pack = new AssetPack( packPath );
+	}
+}
+
+AssetLoader::~AssetLoader()
+{
+	delete pack;
+}
+
+AssetData AssetLoader::load( const string& name )
+{
+	if (pack != nullptr && pack->contains( name ))
+	{
+		return pack->read( name );
+	}
+
+	return AssetData( Util::readFile( name ) );
+}
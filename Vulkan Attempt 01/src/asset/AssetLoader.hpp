@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+
+#include "AssetData.hpp"
+#include "AssetPack.hpp"
+
+using namespace std;
+
+namespace com::gelunox::vulcanUtils
+{
+	//loads assets by their path relative to the working directory
+	//from the pack when there is one and it has the asset, from the loose file otherwise, so a missing pack only costs speed
+	//safe from any thread, the texture streamer's workers load through the same instance
+	class AssetLoader
+	{
+	private:
+		AssetPack * pack = nullptr;
+
+	public:
+		//a pack that doesn't exist is no error, one that is malformed is
+		AssetLoader( const string& packPath );
+		~AssetLoader();
+
+		AssetLoader( const AssetLoader& ) = delete;
+		AssetLoader& operator=( const AssetLoader& ) = delete;
+
+		bool hasPack() { return pack != nullptr; }
+		//views into the pack stay valid until the loader is destroyed
+		AssetData load( const string& name );
+	};
+}
@@ -0,0 +1,208 @@
+#include "AssetPack.hpp"
+
+#include <stdexcept>
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+
+#include "Lz4.hpp"
+#include "../util/Util.hpp"
+
+using namespace com::gelunox::vulcanUtils;
+using namespace std;
+
+static const char PACK_MAGIC[8] = { 'G', 'L', 'X', 'P', 'A', 'C', 'K', 0 };
+static const uint32_t PACK_VERSION = 1;
+
+static int compareName( const char * name, uint32_t nameLength, const string& other )
+{
+	int result = memcmp( name, other.data(), min<size_t>( nameLength, other.size() ) );
+
+	if (result != 0)
+	{
+		return result;
+	}
+	return nameLength < other.size() ? -1 : nameLength > other.size() ? 1 : 0;
+}
+
+AssetPack::AssetPack( const string& path )
+	: file( path )
+{
+	if (file.getSize() < sizeof( PackHeader ))
+	{
+		throw runtime_error( "not an asset pack: " + path );
+	}
+
+	memcpy( &header, file.getData(), sizeof( PackHeader ) );
+
+	if (memcmp( header.magic, PACK_MAGIC, sizeof( PACK_MAGIC ) ) != 0 || header.version != PACK_VERSION)
+	{
+		throw runtime_error( "not an asset pack, or one of another version: " + path );
+	}
+
+	//everything is checked once here so read can trust the table
+	uint64_t size = file.getSize();
+	if (header.tocOffset > size || header.entryCount > (size - header.tocOffset) / sizeof( PackEntry ) || header.namesOffset > size)
+	{
+		throw runtime_error( "asset pack table is truncated: " + path );
+	}
+
+	names = reinterpret_cast<const char *>(file.getData()) + header.namesOffset;
+
+	for (uint32_t i = 0; i < header.entryCount; i++)
+	{
+		PackEntry entry = getEntry( i );
+
+		if (entry.nameOffset > size - header.namesOffset || entry.nameLength > size - header.namesOffset - entry.nameOffset
+			|| entry.offset > size || entry.size > size - entry.offset)
+		{
+			throw runtime_error( "asset pack entry points outside of the pack: " + path );
+		}
+	}
+}
+
+bool AssetPack::contains( const string& name ) const
+{
+	PackEntry entry;
+	return find( name, entry );
+}
+
+AssetData AssetPack::read( const string& name ) const
+{
+	PackEntry entry;
+
+	if (!find( name, entry ))
+	{
+		throw runtime_error( "asset pack has no entry " + name );
+	}
+
+	const char * data = reinterpret_cast<const char *>(file.getData()) + entry.offset;
+
+	if (!(entry.flags & PACK_ENTRY_LZ4))
+	{
+		return AssetData( data, static_cast<size_t>(entry.size) );
+	}
+
+	vector<char> decompressed( static_cast<size_t>(entry.originalSize) );
+	Lz4::decompress( reinterpret_cast<const uint8_t *>(data), static_cast<size_t>(entry.size),
+		reinterpret_cast<uint8_t *>(decompressed.data()), decompressed.size() );
+
+	return AssetData( move( decompressed ) );
+}
+
+PackEntry AssetPack::getEntry( uint32_t index ) const
+{
+	PackEntry entry;
+	memcpy( &entry, file.getData() + header.tocOffset + index * sizeof( PackEntry ), sizeof( PackEntry ) );
+
+	return entry;
+}
+
+bool AssetPack::find( const string& name, PackEntry& entry ) const
+{
+	uint32_t first = 0;
+	uint32_t last = header.entryCount;
+
+	while (first < last)
+	{
+		uint32_t middle = first + (last - first) / 2;
+		entry = getEntry( middle );
+
+		int order = compareName( names + entry.nameOffset, entry.nameLength, name );
+
+		if (order == 0)
+		{
+			return true;
+		}
+		if (order < 0)
+		{
+			first = middle + 1;
+		}
+		else
+		{
+			last = middle;
+		}
+	}
+
+	return false;
+}
+
+AssetPackWriter::AssetPackWriter( uint64_t alignment )
+	: alignment( max<uint64_t>( alignment, 1 ) )
+{
+}
+
+void AssetPackWriter::add( const string& name, const string& path, bool compress )
+{
+	sources.push_back( { name, path, compress } );
+}
+
+void AssetPackWriter::write( const string& path )
+{
+	sort( sources.begin(), sources.end(), []( const Source& a, const Source& b ) { return a.name < b.name; } );
+
+	for (size_t i = 1; i < sources.size(); i++)
+	{
+		if (sources[i].name == sources[i - 1].name)
+		{
+			throw runtime_error( "asset pack has two entries named " + sources[i].name );
+		}
+	}
+
+	vector<char> pack( sizeof( PackHeader ) );
+	vector<PackEntry> entries;
+	string names;
+
+	for (const Source& source : sources)
+	{
+		vector<char> data = Util::readFile( source.path );
+
+		PackEntry entry = {};
+		entry.nameOffset = names.size();
+		entry.nameLength = static_cast<uint32_t>(source.name.size());
+		entry.originalSize = data.size();
+		names += source.name;
+
+		if (source.compress && !data.empty())
+		{
+			vector<uint8_t> compressed = Lz4::compress( reinterpret_cast<const uint8_t *>(data.data()), data.size() );
+
+			if (compressed.size() <= data.size() - data.size() / 8)
+			{
+				data.assign( compressed.begin(), compressed.end() );
+				entry.flags |= PACK_ENTRY_LZ4;
+			}
+		}
+
+		pack.resize( (pack.size() + alignment - 1) / alignment * alignment );
+		entry.offset = pack.size();
+		entry.size = data.size();
+		pack.insert( pack.end(), data.begin(), data.end() );
+
+		entries.push_back( entry );
+	}
+
+	PackHeader header = {};
+	memcpy( header.magic, PACK_MAGIC, sizeof( PACK_MAGIC ) );
+	header.version = PACK_VERSION;
+	header.entryCount = static_cast<uint32_t>(entries.size());
+	header.alignment = alignment;
+
+	//the table itself only needs to be 8 byte aligned
+	pack.resize( (pack.size() + 7) / 8 * 8 );
+	header.tocOffset = pack.size();
+	pack.insert( pack.end(), reinterpret_cast<const char *>(entries.data()), reinterpret_cast<const char *>(entries.data() + entries.size()) );
+
+	header.namesOffset = pack.size();
+	pack.insert( pack.end(), names.begin(), names.end() );
+
+	memcpy( pack.data(), &header, sizeof( PackHeader ) );
+
+	ofstream out( path, ios::binary | ios::trunc );
+	if (!out.is_open())
+	{
+		throw runtime_error( "can't write asset pack " + path );
+	}
+
+	out.write( pack.data(), pack.size() );
+}
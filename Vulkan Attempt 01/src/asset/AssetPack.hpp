@@ -0,0 +1,89 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "AssetData.hpp"
+#include "MappedFile.hpp"
+
+using namespace std;
+
+namespace com::gelunox::vulcanUtils
+{
+	//layout of a pack, all little endian:
+	//PackHeader, the entry data each at a multiple of alignment, the PackEntry table sorted by name, the names without terminators
+	struct PackHeader
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t entryCount;
+		uint64_t tocOffset;
+		uint64_t namesOffset;
+		uint64_t alignment;
+	};
+
+	struct PackEntry
+	{
+		uint64_t nameOffset;
+		uint64_t offset;
+		//bytes in the pack, equal to originalSize unless compressed
+		uint64_t size;
+		uint64_t originalSize;
+		uint32_t nameLength;
+		uint32_t flags;
+	};
+
+	//stored as one LZ4 block
+	const uint32_t PACK_ENTRY_LZ4 = 0x1;
+
+	//a packed archive of assets, read through a memory mapping
+	//uncompressed entries are handed out as views of the mapping, nothing is read until a page is touched
+	//lookups and reads are safe from any thread, the pack itself is never written to
+	class AssetPack
+	{
+	private:
+		MappedFile file;
+		PackHeader header;
+		const char * names;
+
+	public:
+		//throws when the file isn't a pack or its table points outside of it
+		AssetPack( const string& path );
+
+		bool contains( const string& name ) const;
+		//a view for stored entries, a decompressed copy for LZ4 ones, throws when there is no such entry
+		AssetData read( const string& name ) const;
+
+		uint32_t getEntryCount() const { return header.entryCount; }
+
+	private:
+		PackEntry getEntry( uint32_t index ) const;
+		//binary search over the sorted table, false when there is no such entry
+		bool find( const string& name, PackEntry& entry ) const;
+	};
+
+	//builds a pack from files on disk, the whole pack is assembled in memory before it is written
+	class AssetPackWriter
+	{
+	private:
+		struct Source
+		{
+			string name;
+			string path;
+			bool compress;
+		};
+
+		vector<Source> sources;
+		uint64_t alignment;
+
+	public:
+		//page alignment, an entry never shares a page with another and satisfies any buffer copy offset alignment
+		AssetPackWriter( uint64_t alignment = 4096 );
+
+		//name is what the entry is read by, forward slashes like the paths the loaders use
+		//compressed entries are only kept compressed when LZ4 saves at least an eighth of their size
+		void add( const string& name, const string& path, bool compress );
+		void write( const string& path );
+	};
+}
@@ -0,0 +1,190 @@
+#include "Lz4.hpp"
+
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+
+using namespace com::gelunox::vulcanUtils;
+using namespace std;
+
+static const size_t MIN_MATCH = 4;
+//the format requires the last 5 bytes to be literals, and the last match to start 12 bytes before the end
+static const size_t LAST_LITERALS = 5;
+static const size_t MATCH_FIND_LIMIT = 12;
+static const size_t MAX_OFFSET = 65535;
+static const uint32_t HASH_BITS = 16;
+
+static uint32_t read32( const uint8_t * src )
+{
+	uint32_t value;
+	memcpy( &value, src, sizeof( value ) );
+	return value;
+}
+
+static uint32_t hash32( uint32_t sequence )
+{
+	return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+//15 in the token's nibble, the rest as bytes of 255 and a final smaller one
+static void writeLength( vector<uint8_t>& out, size_t length )
+{
+	for (length -= 15; length >= 255; length -= 255)
+	{
+		out.push_back( 255 );
+	}
+	out.push_back( static_cast<uint8_t>(length) );
+}
+
+static void writeSequence( vector<uint8_t>& out, const uint8_t * literals, size_t literalLength, size_t offset, size_t matchLength )
+{
+	uint8_t token = static_cast<uint8_t>(min<size_t>( literalLength, 15 ) << 4);
+	if (matchLength > 0)
+	{
+		token |= static_cast<uint8_t>(min<size_t>( matchLength - MIN_MATCH, 15 ));
+	}
+	out.push_back( token );
+
+	if (literalLength >= 15)
+	{
+		writeLength( out, literalLength );
+	}
+	out.insert( out.end(), literals, literals + literalLength );
+
+	//the last sequence has literals only
+	if (matchLength == 0)
+	{
+		return;
+	}
+
+	out.push_back( static_cast<uint8_t>(offset) );
+	out.push_back( static_cast<uint8_t>(offset >> 8) );
+
+	if (matchLength - MIN_MATCH >= 15)
+	{
+		writeLength( out, matchLength - MIN_MATCH );
+	}
+}
+
+vector<uint8_t> Lz4::compress( const uint8_t * src, size_t srcSize )
+{
+	vector<uint8_t> out;
+	out.reserve( srcSize + srcSize / 255 + 16 );
+
+	size_t anchor = 0;
+
+	if (srcSize > MATCH_FIND_LIMIT)
+	{
+		//positions + 1, 0 is an empty slot
+		vector<uint32_t> table( size_t( 1 ) << HASH_BITS, 0 );
+		size_t matchEnd = srcSize - LAST_LITERALS;
+
+		for (size_t i = 0; i + MATCH_FIND_LIMIT <= srcSize; )
+		{
+			uint32_t sequence = read32( src + i );
+			uint32_t& slot = table[hash32( sequence )];
+			size_t candidate = slot;
+			slot = static_cast<uint32_t>(i + 1);
+
+			if (candidate == 0 || i - (candidate - 1) > MAX_OFFSET || read32( src + candidate - 1 ) != sequence)
+			{
+				i++;
+				continue;
+			}
+
+			size_t match = candidate - 1;
+			size_t length = MIN_MATCH;
+			while (i + length < matchEnd && src[match + length] == src[i + length])
+			{
+				length++;
+			}
+
+			writeSequence( out, src + anchor, i - anchor, i - match, length );
+
+			i += length;
+			anchor = i;
+		}
+	}
+
+	writeSequence( out, src + anchor, srcSize - anchor, 0, 0 );
+
+	return out;
+}
+
+void Lz4::decompress( const uint8_t * src, size_t srcSize, uint8_t * dst, size_t dstSize )
+{
+	size_t in = 0;
+	size_t out = 0;
+
+	auto readLength = [&]( size_t length )
+	{
+		if (length != 15)
+		{
+			return length;
+		}
+
+		uint8_t next;
+		do
+		{
+			if (in >= srcSize)
+			{
+				throw runtime_error( "lz4 block is truncated" );
+			}
+			next = src[in++];
+			length += next;
+		} while (next == 255);
+
+		return length;
+	};
+
+	while (in < srcSize)
+	{
+		uint8_t token = src[in++];
+
+		size_t literalLength = readLength( token >> 4 );
+		if (literalLength > srcSize - in || literalLength > dstSize - out)
+		{
+			throw runtime_error( "lz4 literals run past the end of the block" );
+		}
+
+		memcpy( dst + out, src + in, literalLength );
+		in += literalLength;
+		out += literalLength;
+
+		//the last sequence ends after its literals
+		if (in == srcSize)
+		{
+			break;
+		}
+
+		if (srcSize - in < 2)
+		{
+			throw runtime_error( "lz4 block is truncated" );
+		}
+
+		size_t offset = src[in] | static_cast<size_t>(src[in + 1]) << 8;
+		in += 2;
+
+		if (offset == 0 || offset > out)
+		{
+			throw runtime_error( "lz4 match offset points before the start of the output" );
+		}
+
+		size_t matchLength = readLength( token & 15 ) + MIN_MATCH;
+		if (matchLength > dstSize - out)
+		{
+			throw runtime_error( "lz4 match runs past the end of the output" );
+		}
+
+		//matches may overlap their own output, so no memcpy
+		for (size_t i = 0; i < matchLength; i++, out++)
+		{
+			dst[out] = dst[out - offset];
+		}
+	}
+
+	if (out != dstSize)
+	{
+		throw runtime_error( "lz4 block decompressed to the wrong size" );
+	}
+}
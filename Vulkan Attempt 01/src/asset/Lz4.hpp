@@ -0,0 +1,16 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+using namespace std;
+
+//the LZ4 block format, without the frame around it, the sizes are kept by the caller
+//https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+namespace com::gelunox::vulcanUtils::Lz4
+{
+	//greedy single pass with a hash of the last 4 bytes, fast rather than small
+	vector<uint8_t> compress( const uint8_t * src, size_t srcSize );
+	//dstSize has to be the exact decompressed size, throws on malformed input instead of reading or writing out of bounds
+	void decompress( const uint8_t * src, size_t srcSize, uint8_t * dst, size_t dstSize );
+}
@@ -0,0 +1,123 @@
+#include "MappedFile.hpp"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace com::gelunox::vulcanUtils;
+using namespace std;
+
+#ifdef _WIN32
+
+MappedFile::MappedFile( const string& path )
+{
+	file = CreateFileA( path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		file = nullptr;
+		throw runtime_error( "can't open file " + path );
+	}
+
+	LARGE_INTEGER fileSize;
+	GetFileSizeEx( file, &fileSize );
+	size = static_cast<size_t>(fileSize.QuadPart);
+
+	//an empty file can't be mapped, it stays a null view of size 0
+	if (size == 0)
+	{
+		return;
+	}
+
+	mapping = CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+
+	if (mapping == nullptr)
+	{
+		CloseHandle( file );
+		throw runtime_error( "can't map file " + path );
+	}
+
+	data = static_cast<const uint8_t *>(MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 ));
+
+	if (data == nullptr)
+	{
+		CloseHandle( mapping );
+		CloseHandle( file );
+		throw runtime_error( "can't map file " + path );
+	}
+}
+
+MappedFile::~MappedFile()
+{
+	if (data != nullptr)
+	{
+		UnmapViewOfFile( data );
+	}
+	if (mapping != nullptr)
+	{
+		CloseHandle( mapping );
+	}
+	if (file != nullptr)
+	{
+		CloseHandle( file );
+	}
+}
+
+#else
+
+MappedFile::MappedFile( const string& path )
+{
+	file = open( path.c_str(), O_RDONLY );
+
+	if (file < 0)
+	{
+		throw runtime_error( "can't open file " + path );
+	}
+
+	struct stat info;
+	if (fstat( file, &info ) != 0)
+	{
+		close( file );
+		throw runtime_error( "can't read the size of " + path );
+	}
+	size = static_cast<size_t>(info.st_size);
+
+	//an empty file can't be mapped, it stays a null view of size 0
+	if (size == 0)
+	{
+		return;
+	}
+
+	void * view = mmap( nullptr, size, PROT_READ, MAP_PRIVATE, file, 0 );
+
+	if (view == MAP_FAILED)
+	{
+		close( file );
+		throw runtime_error( "can't map file " + path );
+	}
+
+	data = static_cast<const uint8_t *>(view);
+}
+
+MappedFile::~MappedFile()
+{
+	if (data != nullptr)
+	{
+		munmap( const_cast<uint8_t *>(data), size );
+	}
+	if (file >= 0)
+	{
+		close( file );
+	}
+}
+
+#endif
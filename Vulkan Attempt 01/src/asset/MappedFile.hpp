@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+using namespace std;
+
+namespace com::gelunox::vulcanUtils
+{
+	//a whole file mapped read only, pages are faulted in by the os when they are first read
+	class MappedFile
+	{
+	private:
+		const uint8_t * data = nullptr;
+		size_t size = 0;
+
+#ifdef _WIN32
+		void * file = nullptr;
+		void * mapping = nullptr;
+#else
+		int file = -1;
+#endif
+
+	public:
+		MappedFile( const string& path );
+		~MappedFile();
+
+		MappedFile( const MappedFile& ) = delete;
+		MappedFile& operator=( const MappedFile& ) = delete;
+
+		const uint8_t * getData() const { return data; }
+		size_t getSize() const { return size; }
+	};
+}
@@ -0,0 +1,76 @@
+#include "ComputePipelineBuilder.hpp"
+
+using namespace com::gelunox::vulcanUtils;
+using namespace std;
+
+typedef ComputePipelineBuilder::This This;
+
+ComputePipelineBuilder::ComputePipelineBuilder( VkDevice & device ) : device( device )
+{
+	pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+	pipelineInfo.basePipelineIndex = -1;
+}
+
+ComputePipelineBuilder::~ComputePipelineBuilder()
+{
+	if (shaderModule != VK_NULL_HANDLE)
+	{
+		vkDestroyShaderModule( device, shaderModule, nullptr );
+	}
+}
+
+This ComputePipelineBuilder::setShader( const AssetData& code, const char* name )
+{
+	if (shaderModule != VK_NULL_HANDLE)
+	{
+		vkDestroyShaderModule( device, shaderModule, nullptr );
+	}
+
+	VkShaderModuleCreateInfo createInfo = {};
+	createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+	createInfo.codeSize = code.size();
+	createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+
+	if (vkCreateShaderModule( device, &createInfo, nullptr, &shaderModule ) != VK_SUCCESS)
+	{
+		throw runtime_error( "Can't create shader module" );
+	}
+
+	pipelineInfo.stage.module = shaderModule;
+	pipelineInfo.stage.pName = name;
+	return *this;
+}
+
+This ComputePipelineBuilder::setPipelineLayout( VkPipelineLayout& layout )
+{
+	pipelineInfo.layout = layout;
+
+	return *this;
+}
+
+This ComputePipelineBuilder::setPipelineCache( VkPipelineCache cache )
+{
+	this->cache = cache;
+
+	return *this;
+}
+
+VkPipeline ComputePipelineBuilder::build()
+{
+	if (shaderModule == VK_NULL_HANDLE)
+	{
+		throw logic_error( "compute pipeline needs a shader" );
+	}
+
+	VkPipeline pipeline;
+
+	if (vkCreateComputePipelines( device, cache, 1, &pipelineInfo, nullptr, &pipeline ) != VK_SUCCESS)
+	{
+		throw runtime_error( "compute pipeline creation failed" );
+	}
+
+	return pipeline;
+}
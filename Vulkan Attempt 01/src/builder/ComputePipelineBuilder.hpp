@@ -0,0 +1,34 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <stdexcept>
+
+#include "../asset/AssetData.hpp"
+
+using namespace std;
+
+namespace com::gelunox::vulcanUtils
+{
+	//a compute pipeline only has a single stage and a layout, everything else is fixed
+	class ComputePipelineBuilder
+	{
+	public:
+		typedef ComputePipelineBuilder & This;
+
+	private:
+		VkComputePipelineCreateInfo pipelineInfo = {};
+
+		VkDevice device;
+		VkPipelineCache cache = VK_NULL_HANDLE;
+
+		VkShaderModule shaderModule = VK_NULL_HANDLE;
+	public:
+		ComputePipelineBuilder( VkDevice & device );
+		~ComputePipelineBuilder();
+
+		This setShader( const AssetData& code, const char* name );
+		This setPipelineLayout( VkPipelineLayout& layout );
+		This setPipelineCache( VkPipelineCache cache );
+		VkPipeline build();
+	};
+};
@@ -1,5 +1,7 @@
 #include "DescriptorPoolBuilder.hpp"
 
+#include <stdexcept>
+
 using namespace com::gelunox::vulcanUtils;
 
 typedef DescriptorPoolBuilder::This This;
@@ -21,6 +23,13 @@ This DescriptorPoolBuilder::addPoolSize(VkDescriptorType type, uint32_t count)
 	return *this;
 }
 
+This DescriptorPoolBuilder::setMaxSets( uint32_t maxSets )
+{
+	createInfo.maxSets = maxSets;
+
+	return *this;
+}
+
 VkDescriptorPool DescriptorPoolBuilder::build()
 {
 	createInfo.poolSizeCount = poolSizes.size();
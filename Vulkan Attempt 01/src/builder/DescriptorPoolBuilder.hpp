@@ -21,6 +21,7 @@ namespace com::gelunox::vulcanUtils
 		DescriptorPoolBuilder(VkDevice& device);
 
 		This addPoolSize( VkDescriptorType type, uint32_t count );
+		This setMaxSets( uint32_t maxSets );
 
 		VkDescriptorPool build();
 	};
@@ -1,5 +1,7 @@
 #include "DescriptorSetLayoutBuilder.hpp"
 
+#include <stdexcept>
+
 using namespace com::gelunox::vulcanUtils;
 
 typedef DescriptorSetLayoutBuilder::This This;
@@ -1,5 +1,7 @@
 #include "FramebufferBuilder.hpp"
 
+#include <stdexcept>
+
 using namespace com::gelunox::vulcanUtils;
 
 typedef FramebufferBuilder::This This;
@@ -1,5 +1,7 @@
 #include "ImageViewBuilder.hpp"
 
+#include <stdexcept>
+
 using namespace com::gelunox::vulcanUtils;
 
 typedef ImageViewBuilder::This This;
@@ -33,6 +35,13 @@ This ImageViewBuilder::setFormat( VkFormat format )
 	return *this;
 }
 
+This ImageViewBuilder::setMipLevels( uint32_t levelCount )
+{
+	createInfo.subresourceRange.levelCount = levelCount;
+
+	return *this;
+}
+
 VkImageView ImageViewBuilder::build()
 {
 	VkImageView imageView;
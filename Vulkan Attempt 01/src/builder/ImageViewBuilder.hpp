@@ -22,6 +22,8 @@ namespace com::gelunox::vulcanUtils
 
 		This setImage( VkImage& image );
 		This setFormat( VkFormat format );
+		//levels visible through the view, starting at level 0
+		This setMipLevels( uint32_t levelCount );
 
 		VkImageView build();
 	};
@@ -1,5 +1,7 @@
 #include "InstanceBuilder.hpp"
 
+#include <stdexcept>
+
 using namespace com::gelunox::vulcanUtils;
 
 typedef InstanceBuilder::This This;
@@ -1,5 +1,7 @@
 #include "LogicalDeviceBuilder.hpp"
 
+#include <stdexcept>
+
 using namespace com::gelunox::vulcanUtils;
 
 typedef LogicalDeviceBuilder::This This;
@@ -54,6 +56,27 @@ This LogicalDeviceBuilder::setFeatureSamplerAnisotrophy(VkBool32 enabled)
 	return *this;
 }
 
+This LogicalDeviceBuilder::setFeatureMultiDrawIndirect( VkBool32 enabled )
+{
+	deviceFeatures.multiDrawIndirect = enabled;
+
+	return *this;
+}
+
+This LogicalDeviceBuilder::setFeatureDrawIndirectFirstInstance( VkBool32 enabled )
+{
+	deviceFeatures.drawIndirectFirstInstance = enabled;
+
+	return *this;
+}
+
+This LogicalDeviceBuilder::setFeatureTextureCompressionBC( VkBool32 enabled )
+{
+	deviceFeatures.textureCompressionBC = enabled;
+
+	return *this;
+}
+
 VkDevice LogicalDeviceBuilder::build()
 {
 	//Queue createInfos
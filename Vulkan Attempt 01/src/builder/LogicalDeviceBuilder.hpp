@@ -30,6 +30,9 @@ namespace com::gelunox::vulcanUtils
 		This addExtensions( vector<const char*> extensions );
 		This setValidationLayersEnabled( bool enabled );
 		This setFeatureSamplerAnisotrophy( VkBool32 enabled );
+		This setFeatureMultiDrawIndirect( VkBool32 enabled );
+		This setFeatureDrawIndirectFirstInstance( VkBool32 enabled );
+		This setFeatureTextureCompressionBC( VkBool32 enabled );
 
 		VkDevice build();
 	};
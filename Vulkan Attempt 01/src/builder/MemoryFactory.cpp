@@ -1,7 +1,8 @@
 #include "MemoryFactory.hpp"
 
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb_image.h>
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
 
 using namespace com::gelunox::vulcanUtils;
 
@@ -15,82 +16,148 @@ MemoryFactory::~MemoryFactory()
 {
 }
 
-void MemoryFactory::createTextureImage( char * location, VkImage& dstImage, VkDeviceMemory& dstMemory )
+void MemoryFactory::createTextureImage( const char * location, VkImage& dstImage, Allocation& dstMemory, uint32_t& mipLevels, VkFormat& format )
 {
-	int texWidth,
-		texHeight,
-		texChannels;
+	createTextureImage( TextureFile::load( location ), dstImage, dstMemory, mipLevels, format );
+}
+
+void MemoryFactory::createTextureImage( const TextureFile& file, VkImage& dstImage, Allocation& dstMemory, uint32_t& mipLevels, VkFormat& format )
+{
+	CpuScope scope( "MemoryFactory::createTextureImage" );
 
-	stbi_uc* pixels = stbi_load( location, &texWidth, &texHeight, &texChannels, STBI_rgb_alpha );
-	VkDeviceSize imageSize = texWidth * texHeight * 4;
+	bool ownBatch = !batchOpen;
+	if (ownBatch)
+	{
+		beginBatch();
+	}
 
-	if (!pixels)
+	if (file.generateMips)
 	{
-		throw runtime_error( "couldn't load image" );
+		createMipmappedImage( file, dstImage, dstMemory, mipLevels, format );
 	}
+	else
+	{
+		createContainerImage( file, dstImage, dstMemory, mipLevels, format );
+	}
+
+	if (ownBatch)
+	{
+		wait( submitBatch() );
+	}
+}
+
+void MemoryFactory::createMipmappedImage( const TextureFile& file, VkImage& dstImage, Allocation& dstMemory, uint32_t& mipLevels, VkFormat& format )
+{
+	const uint8_t * pixels = file.getLevelData( 0 );
+
+	format = VK_FORMAT_R8G8B8A8_UNORM;
+	uint32_t width = file.width;
+	uint32_t height = file.height;
+	mipLevels = Util::getMipLevelCount( width, height );
+	bool gpuMipmaps = supportsLinearBlit( VK_FORMAT_R8G8B8A8_UNORM );
+
+	//the blits read from the level above
+	createSampledImage( width, height, mipLevels, format, gpuMipmaps ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT : 0, dstImage, dstMemory );
+
+	transitionImageLayout( dstImage, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels );
 
-	VkBuffer stagingBuffer;
-	VkDeviceMemory stagingMemory;
-	createBuffer( imageSize,
-		VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-		stagingBuffer, stagingMemory );
+	uploadLevel( pixels, dstImage, width, height, 0 );
+
+	if (gpuMipmaps)
+	{
+		releaseForMipmaps( { dstImage, width, height, mipLevels } );
+	}
+	else
+	{
+		//every level is staged like level 0, the ring copies the data so the buffers can be reused right away
+		vector<uint8_t> level( pixels, pixels + static_cast<size_t>(width) * height * 4 );
+		vector<uint8_t> next;
+
+		for (uint32_t mip = 1; mip < mipLevels; mip++)
+		{
+			next.resize( static_cast<size_t>(max( width / 2, 1u )) * max( height / 2, 1u ) * 4 );
+			Util::downsampleRgba8( level.data(), width, height, next.data() );
+
+			width = max( width / 2, 1u );
+			height = max( height / 2, 1u );
+			level.swap( next );
+
+			uploadLevel( level.data(), dstImage, width, height, mip );
+		}
+
+		releaseImage( dstImage, mipLevels );
+	}
+}
+
+//the levels come from the file as they are, or decoded to rgba8 when the device can't sample the format
+void MemoryFactory::createContainerImage( const TextureFile& file, VkImage& dstImage, Allocation& dstMemory, uint32_t& mipLevels, VkFormat& format )
+{
+	bool transcode = !supportsSampling( file.format );
+
+	if (transcode && !BlockDecoder::canDecode( file.format ))
+	{
+		throw runtime_error( "texture format isn't supported by the device and can't be decoded on the cpu" );
+	}
 
-	void* data;
-	vkMapMemory( logicalDevice, stagingMemory, 0, imageSize, 0, &data );
-	memcpy( data, pixels, (size_t)imageSize );
-	vkUnmapMemory( logicalDevice, stagingMemory );
+	format = transcode ? BlockDecoder::getDecodedFormat( file.format ) : file.format;
+	mipLevels = static_cast<uint32_t>(file.levels.size());
 
-	stbi_image_free( pixels );
+	createSampledImage( file.width, file.height, mipLevels, format, 0, dstImage, dstMemory );
 
+	transitionImageLayout( dstImage, format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels );
+
+	vector<uint8_t> decoded;
+
+	for (uint32_t level = 0; level < mipLevels; level++)
+	{
+		const TextureLevel& info = file.levels[level];
+
+		if (transcode)
+		{
+			decoded.resize( static_cast<size_t>(info.width) * info.height * 4 );
+			BlockDecoder::decode( file.format, file.getLevelData( level ), info.width, info.height, decoded.data() );
+
+			uploadLevel( decoded.data(), dstImage, info.width, info.height, level );
+		}
+		else
+		{
+			uploadLevel( file.getLevelData( level ), dstImage, info.width, info.height, level, TextureFile::getFormatBlock( format ) );
+		}
+	}
+
+	releaseImage( dstImage, mipLevels );
+}
+
+void MemoryFactory::createSampledImage( uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageUsageFlags extraUsage,
+	VkImage& image, Allocation& memory )
+{
 	VkImageCreateInfo imageInfo = {};
 	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
 	imageInfo.imageType = VK_IMAGE_TYPE_2D;
-	imageInfo.extent.width = static_cast<uint32_t>(texWidth);
-	imageInfo.extent.height = static_cast<uint32_t>(texHeight);
+	imageInfo.extent.width = width;
+	imageInfo.extent.height = height;
 	imageInfo.extent.depth = 1;
-	imageInfo.mipLevels = 1;
+	imageInfo.mipLevels = mipLevels;
 	imageInfo.arrayLayers = 1;
-	imageInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+	imageInfo.format = format;
 	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
 	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+	imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | extraUsage;
 	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
 	imageInfo.flags = 0;
 
-	if (vkCreateImage( logicalDevice, &imageInfo, nullptr, &dstImage ) != VK_SUCCESS)
+	if (vkCreateImage( logicalDevice, &imageInfo, nullptr, &image ) != VK_SUCCESS)
 	{
 		throw runtime_error( "Image creation failed" );
 	}
 
-	VkMemoryRequirements memReq;
-	vkGetImageMemoryRequirements( logicalDevice, dstImage, &memReq );
-
-	VkMemoryAllocateInfo allocInfo = {};
-	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	allocInfo.allocationSize = memReq.size;
-	allocInfo.memoryTypeIndex = Util::findMemoryType( physicalDevice, memReq.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT );
-
-	if (vkAllocateMemory( logicalDevice, &allocInfo, nullptr, &dstMemory ) != VK_SUCCESS)
-	{
-		throw runtime_error( "Image memory creation failed" );
-	}
-
-	vkBindImageMemory( logicalDevice, dstImage, dstMemory, 0 );
-
-	//these could be combined into a single commandbuffer
-	transitionImageLayout( dstImage, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL );
-	copyBufferToImage(stagingBuffer, dstImage, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight) );
-	transitionImageLayout( dstImage, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL );
-
-	vkDestroyBuffer( logicalDevice, stagingBuffer, nullptr );
-	vkFreeMemory( logicalDevice, stagingMemory, nullptr );
+	memory = allocator->allocateForImage( image, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT );
 }
 
-void MemoryFactory::transitionImageLayout( VkImage& image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout )
+void MemoryFactory::transitionImageLayout( VkImage& image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t levelCount )
 {
-	VkCommandBuffer cmdBuffer = beginOneTimeUsageCommand();
+	VkCommandBuffer cmdBuffer = record();
 
 	VkPipelineStageFlags srcStage;
 	VkPipelineStageFlags dstStage;
@@ -104,7 +171,7 @@ void MemoryFactory::transitionImageLayout( VkImage& image, VkFormat format, VkIm
 	barrier.image = image;
 	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 	barrier.subresourceRange.baseMipLevel = 0;
-	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.levelCount = levelCount;
 	barrier.subresourceRange.baseArrayLayer = 0;
 	barrier.subresourceRange.layerCount = 1;
 
@@ -136,56 +203,74 @@ void MemoryFactory::transitionImageLayout( VkImage& image, VkFormat format, VkIm
 		0, nullptr,
 		1, &barrier );
 
-	endOneTimeUsageCommand( cmdBuffer );
+	endRecord();
 }
 
-void MemoryFactory::copyBufferToImage( VkBuffer& buffer, VkImage& image, uint32_t width, uint32_t height )
+void MemoryFactory::copyBufferToImage( VkBuffer& buffer, VkImage& image, uint32_t width, uint32_t height, VkDeviceSize bufferOffset, int32_t y,
+	uint32_t mipLevel )
 {
-	VkCommandBuffer cmdBuffer = beginOneTimeUsageCommand();
+	VkCommandBuffer cmdBuffer = record();
 
 	VkBufferImageCopy region = {};
-	region.bufferOffset = 0;
+	region.bufferOffset = bufferOffset;
 	region.bufferRowLength = 0;
 	region.bufferImageHeight = 0;
 	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-	region.imageSubresource.mipLevel = 0;
+	region.imageSubresource.mipLevel = mipLevel;
 	region.imageSubresource.baseArrayLayer = 0;
 	region.imageSubresource.layerCount = 1;
-	region.imageOffset = { 0,0,0 };
+	region.imageOffset = { 0,y,0 };
 	region.imageExtent = { width, height, 1 };
 
 	vkCmdCopyBufferToImage( cmdBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region );
 
-	endOneTimeUsageCommand( cmdBuffer );
+	endRecord();
 }
 
-void MemoryFactory::createBufferMemory( VkDeviceSize size, void const* srcData, VkBuffer& dstBuffer, VkDeviceMemory& dstMemory, VkBufferUsageFlagBits flags )
+void MemoryFactory::createBufferMemory( VkDeviceSize size, void const* srcData, VkBuffer& dstBuffer, Allocation& dstMemory, VkBufferUsageFlagBits flags )
 {
-	VkBuffer stagingBuffer;
-	VkDeviceMemory stagingMemory;
-
-	createBuffer( size,
-		VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-		stagingBuffer, stagingMemory );
-
-	void* data;
-	vkMapMemory( logicalDevice, stagingMemory, 0, size, 0, &data );
-	memcpy( data, srcData, (size_t)size );
-	vkUnmapMemory( logicalDevice, stagingMemory );
+	CpuScope scope( "MemoryFactory::createBufferMemory" );
 
 	createBuffer( size,
 		VK_BUFFER_USAGE_TRANSFER_DST_BIT | flags,
 		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
 		dstBuffer, dstMemory );
 
-	copyBuffer( stagingBuffer, dstBuffer, size );
+	uploadToBuffer( size, srcData, dstBuffer, 0, flags );
+}
+
+void MemoryFactory::uploadToBuffer( VkDeviceSize size, void const * srcData, VkBuffer dstBuffer, VkDeviceSize dstOffset, VkBufferUsageFlags usage )
+{
+	//a barrier can't cover an empty range
+	if (size == 0)
+	{
+		return;
+	}
+
+	bool ownBatch = !batchOpen;
+	if (ownBatch)
+	{
+		beginBatch();
+	}
+
+	for (VkDeviceSize done = 0; done < size; )
+	{
+		StagingRegion region = reserveStaging( min( getChunkSize(), size - done ) );
+		memcpy( region.mapped, static_cast<const char*>(srcData) + done, (size_t)region.size );
+
+		copyBuffer( region.buffer, dstBuffer, region.size, region.offset, dstOffset + done );
+		done += region.size;
+	}
+
+	releaseBuffer( dstBuffer, usage, dstOffset, size );
 
-	vkDestroyBuffer( logicalDevice, stagingBuffer, nullptr );
-	vkFreeMemory( logicalDevice, stagingMemory, nullptr );
+	if (ownBatch)
+	{
+		wait( submitBatch() );
+	}
 }
 
-void MemoryFactory::createBuffer( VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags property, VkBuffer &buffer, VkDeviceMemory &memory )
+void MemoryFactory::createBuffer( VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags property, VkBuffer &buffer, Allocation &memory )
 {
 	VkBufferCreateInfo bufferInfo = {};
 	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -198,45 +283,66 @@ void MemoryFactory::createBuffer( VkDeviceSize size, VkBufferUsageFlags usage, V
 		throw runtime_error( "Error creating vertex buffer" );
 	}
 
-	VkMemoryRequirements memReq;
-	vkGetBufferMemoryRequirements( logicalDevice, buffer, &memReq );
-
-	VkMemoryAllocateInfo allocInfo = {};
-	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	allocInfo.allocationSize = memReq.size;
-	allocInfo.memoryTypeIndex = Util::findMemoryType( physicalDevice, memReq.memoryTypeBits, property );
+	memory = allocator->allocateForBuffer( buffer, property );
+}
 
-	if (vkAllocateMemory( logicalDevice, &allocInfo, nullptr, &memory ) != VK_SUCCESS)
-	{
-		throw runtime_error( "could not allocate gpu memory" );
-	}
+void MemoryFactory::destroyBuffer( VkBuffer& buffer, Allocation& memory )
+{
+	vkDestroyBuffer( logicalDevice, buffer, nullptr );
+	allocator->free( memory );
+	buffer = VK_NULL_HANDLE;
+}
 
-	vkBindBufferMemory( logicalDevice, buffer, memory, 0 );
+void MemoryFactory::destroyImage( VkImage& image, Allocation& memory )
+{
+	vkDestroyImage( logicalDevice, image, nullptr );
+	allocator->free( memory );
+	image = VK_NULL_HANDLE;
 }
 
-void MemoryFactory::copyBuffer( VkBuffer src, VkBuffer dst, VkDeviceSize size )
+void MemoryFactory::copyBuffer( VkBuffer src, VkBuffer dst, VkDeviceSize size, VkDeviceSize srcOffset, VkDeviceSize dstOffset )
 {
-	VkCommandBuffer cmdBuffer = beginOneTimeUsageCommand();
+	VkCommandBuffer cmdBuffer = record();
 
 	VkBufferCopy copyRegion = {};
-	copyRegion.srcOffset = 0;
-	copyRegion.dstOffset = 0;
+	copyRegion.srcOffset = srcOffset;
+	copyRegion.dstOffset = dstOffset;
 	copyRegion.size = size;
 	vkCmdCopyBuffer( cmdBuffer, src, dst, 1, &copyRegion );
 
-	endOneTimeUsageCommand( cmdBuffer );
+	endRecord();
 }
 
 VkCommandBuffer MemoryFactory::beginOneTimeUsageCommand()
 {
-	VkCommandBufferAllocateInfo allocInfo = {};
-	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-	allocInfo.commandPool = commandPool;
-	allocInfo.commandBufferCount = 1;
+	return beginOneTimeUsageCommand( commandPool, freeCopyBuffers );
+}
 
+VkCommandBuffer MemoryFactory::beginOneTimeUsageCommand( VkCommandPool pool, vector<VkCommandBuffer>& recycled )
+{
 	VkCommandBuffer cmdBuffer;
-	vkAllocateCommandBuffers( logicalDevice, &allocInfo, &cmdBuffer );
+
+	if (!recycled.empty())
+	{
+		//vkBeginCommandBuffer resets it implicitly
+		cmdBuffer = recycled.back();
+		recycled.pop_back();
+		commandBufferStats.reused++;
+	}
+	else
+	{
+		VkCommandBufferAllocateInfo allocInfo = {};
+		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocInfo.commandPool = pool;
+		allocInfo.commandBufferCount = 1;
+
+		if (vkAllocateCommandBuffers( logicalDevice, &allocInfo, &cmdBuffer ) != VK_SUCCESS)
+		{
+			throw runtime_error( "upload command buffer allocation failed" );
+		}
+		commandBufferStats.allocated++;
+	}
 
 	VkCommandBufferBeginInfo beginInfo = {};
 	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -246,17 +352,470 @@ VkCommandBuffer MemoryFactory::beginOneTimeUsageCommand()
 	return cmdBuffer;
 }
 
-void MemoryFactory::endOneTimeUsageCommand( VkCommandBuffer& cmdBuffer )
+void MemoryFactory::setQueueFamilies( uint32_t copyFamily, uint32_t graphicsFamily )
+{
+	this->copyFamily = copyFamily;
+	this->graphicsFamily = graphicsFamily;
+
+	uint32_t familyCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties( physicalDevice, &familyCount, nullptr );
+	vector<VkQueueFamilyProperties> families( familyCount );
+	vkGetPhysicalDeviceQueueFamilyProperties( physicalDevice, &familyCount, families.data() );
+
+	copyGranularity = families[copyFamily].minImageTransferGranularity;
+}
+
+void MemoryFactory::beginBatch()
+{
+	if (batchOpen)
+	{
+		throw logic_error( "an upload batch is already open" );
+	}
+
+	freeFinishedBuffers();
+	batchOpen = true;
+}
+
+UploadTicket MemoryFactory::submitBatch()
+{
+	submitRecorded();
+	batchOpen = false;
+
+	UploadTicket ticket;
+	ticket.serial = lastSerial;
+
+	return ticket;
+}
+
+bool MemoryFactory::isComplete( UploadTicket ticket )
 {
-	vkEndCommandBuffer( cmdBuffer );
+	bool complete = stagingRing->isComplete( ticket.serial );
+	freeFinishedBuffers();
+
+	return complete;
+}
+
+void MemoryFactory::wait( UploadTicket ticket )
+{
+	CpuScope scope( "MemoryFactory::wait" );
+	stagingRing->wait( ticket.serial );
+	freeFinishedBuffers();
+}
+
+void MemoryFactory::releaseUploadResources()
+{
+	if (batchOpen)
+	{
+		submitBatch();
+	}
+
+	wait( { lastSerial } );
+
+	for (VkSemaphore semaphore : freeSemaphores)
+	{
+		vkDestroySemaphore( logicalDevice, semaphore, nullptr );
+	}
+	freeSemaphores.clear();
+
+	//the command buffers are freed along with their pools
+	freeCopyBuffers.clear();
+	freeAcquireBuffers.clear();
+}
+
+VkCommandBuffer MemoryFactory::record()
+{
+	if (batchBuffer == VK_NULL_HANDLE)
+	{
+		batchBuffer = beginOneTimeUsageCommand();
+	}
+
+	return batchBuffer;
+}
+
+void MemoryFactory::endRecord()
+{
+	//a lone call outside of a batch is done when it returns, like it always was
+	if (!batchOpen)
+	{
+		wait( submitBatch() );
+	}
+}
+
+void MemoryFactory::submitRecorded()
+{
+	CpuScope scope( "MemoryFactory::submitRecorded" );
+
+	if (batchBuffer == VK_NULL_HANDLE)
+	{
+		return;
+	}
+
+	vkEndCommandBuffer( batchBuffer );
+
+	//the staging ring's fence doubles as the batch fence, its serial is the ticket
+	Submission submission = {};
+	submission.copy = batchBuffer;
+	VkFence fence = stagingRing->commit( submission.serial );
+	lastSerial = submission.serial;
 
 	VkSubmitInfo submitInfo = {};
 	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 	submitInfo.commandBufferCount = 1;
-	submitInfo.pCommandBuffers = &cmdBuffer;
+	submitInfo.pCommandBuffers = &batchBuffer;
 
-	vkQueueSubmit( copyQueue, 1, &submitInfo, VK_NULL_HANDLE );
-	vkQueueWaitIdle( copyQueue );
+	if (bufferAcquires.empty() && imageAcquires.empty())
+	{
+		if (vkQueueSubmit( copyQueue, 1, &submitInfo, fence ) != VK_SUCCESS)
+		{
+			throw runtime_error( "upload submission failed" );
+		}
+	}
+	else
+	{
+		//the copy queue signals, the graphics queue waits for it and acquires the released resources
+		submission.copied = getSemaphore();
+		submitInfo.signalSemaphoreCount = 1;
+		submitInfo.pSignalSemaphores = &submission.copied;
+
+		if (vkQueueSubmit( copyQueue, 1, &submitInfo, VK_NULL_HANDLE ) != VK_SUCCESS)
+		{
+			throw runtime_error( "upload submission failed" );
+		}
+
+		submission.acquire = beginOneTimeUsageCommand( graphicsPool, freeAcquireBuffers );
+
+		vkCmdPipelineBarrier( submission.acquire,
+			acquireStages, acquireStages,
+			0,
+			0, nullptr,
+			static_cast<uint32_t>(bufferAcquires.size()), bufferAcquires.data(),
+			static_cast<uint32_t>(imageAcquires.size()), imageAcquires.data() );
+
+		for (const MipmapJob& job : mipmapJobs)
+		{
+			recordMipmaps( submission.acquire, job );
+		}
+		mipmapJobs.clear();
+
+		vkEndCommandBuffer( submission.acquire );
+
+		VkSubmitInfo acquireInfo = {};
+		acquireInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		acquireInfo.waitSemaphoreCount = 1;
+		acquireInfo.pWaitSemaphores = &submission.copied;
+		acquireInfo.pWaitDstStageMask = &acquireStages;
+		acquireInfo.commandBufferCount = 1;
+		acquireInfo.pCommandBuffers = &submission.acquire;
+
+		//fenced on the graphics side, the ticket completes once the resources are usable there
+		if (vkQueueSubmit( graphicsQueue, 1, &acquireInfo, fence ) != VK_SUCCESS)
+		{
+			throw runtime_error( "upload acquire submission failed" );
+		}
+
+		bufferAcquires.clear();
+		imageAcquires.clear();
+		acquireStages = 0;
+	}
+
+	submissions.push_back( submission );
+	batchBuffer = VK_NULL_HANDLE;
+}
 
-	vkFreeCommandBuffers( logicalDevice, commandPool, 1, &cmdBuffer );
-}
\ No newline at end of file
+void MemoryFactory::freeFinishedBuffers()
+{
+	while (!submissions.empty() && stagingRing->isComplete( submissions.front().serial ))
+	{
+		Submission& submission = submissions.front();
+
+		freeCopyBuffers.push_back( submission.copy );
+
+		if (submission.acquire != VK_NULL_HANDLE)
+		{
+			freeAcquireBuffers.push_back( submission.acquire );
+			freeSemaphores.push_back( submission.copied );
+		}
+
+		submissions.pop_front();
+	}
+}
+
+VkSemaphore MemoryFactory::getSemaphore()
+{
+	if (!freeSemaphores.empty())
+	{
+		VkSemaphore semaphore = freeSemaphores.back();
+		freeSemaphores.pop_back();
+
+		return semaphore;
+	}
+
+	VkSemaphoreCreateInfo spInfo = {};
+	spInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+	VkSemaphore semaphore;
+	if (vkCreateSemaphore( logicalDevice, &spInfo, nullptr, &semaphore ) != VK_SUCCESS)
+	{
+		throw runtime_error( "semaphore creation failed" );
+	}
+
+	return semaphore;
+}
+
+void MemoryFactory::releaseBuffer( VkBuffer buffer, VkBufferUsageFlags usage, VkDeviceSize offset, VkDeviceSize size )
+{
+	VkAccessFlags dstAccess = 0;
+	VkPipelineStageFlags dstStage = 0;
+
+	if (usage & VK_BUFFER_USAGE_VERTEX_BUFFER_BIT)
+	{
+		dstAccess |= VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+		dstStage |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+	}
+	if (usage & VK_BUFFER_USAGE_INDEX_BUFFER_BIT)
+	{
+		dstAccess |= VK_ACCESS_INDEX_READ_BIT;
+		dstStage |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+	}
+	if (usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)
+	{
+		dstAccess |= VK_ACCESS_UNIFORM_READ_BIT;
+		dstStage |= VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	}
+	if (usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+	{
+		dstAccess |= VK_ACCESS_SHADER_READ_BIT;
+		dstStage |= VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	}
+	if (dstStage == 0)
+	{
+		dstAccess = VK_ACCESS_MEMORY_READ_BIT;
+		dstStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+	}
+
+	VkBufferMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.buffer = buffer;
+	barrier.offset = offset;
+	barrier.size = size;
+
+	if (!hasOwnershipTransfer())
+	{
+		barrier.dstAccessMask = dstAccess;
+		vkCmdPipelineBarrier( record(), VK_PIPELINE_STAGE_TRANSFER_BIT, dstStage, 0, 0, nullptr, 1, &barrier, 0, nullptr );
+
+		return;
+	}
+
+	//release on the copy queue, the destination stages don't exist there
+	barrier.srcQueueFamilyIndex = copyFamily;
+	barrier.dstQueueFamilyIndex = graphicsFamily;
+	barrier.dstAccessMask = 0;
+	vkCmdPipelineBarrier( record(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr );
+
+	barrier.srcAccessMask = 0;
+	barrier.dstAccessMask = dstAccess;
+	bufferAcquires.push_back( barrier );
+	acquireStages |= dstStage;
+}
+
+void MemoryFactory::releaseImage( VkImage image, uint32_t levelCount )
+{
+	if (!hasOwnershipTransfer())
+	{
+		transitionImageLayout( image, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, levelCount );
+
+		return;
+	}
+
+	//the layout transition has to be identical in the release and acquire barrier
+	VkImageMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	barrier.srcQueueFamilyIndex = copyFamily;
+	barrier.dstQueueFamilyIndex = graphicsFamily;
+	barrier.image = image;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.baseMipLevel = 0;
+	barrier.subresourceRange.levelCount = levelCount;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = 1;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = 0;
+
+	vkCmdPipelineBarrier( record(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier );
+
+	barrier.srcAccessMask = 0;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	imageAcquires.push_back( barrier );
+	acquireStages |= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+}
+
+void MemoryFactory::releaseForMipmaps( const MipmapJob& job )
+{
+	if (!hasOwnershipTransfer())
+	{
+		recordMipmaps( record(), job );
+		endRecord();
+
+		return;
+	}
+
+	//the chain stays in TRANSFER_DST_OPTIMAL across the transfer, the blits after the acquire move it on
+	VkImageMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.srcQueueFamilyIndex = copyFamily;
+	barrier.dstQueueFamilyIndex = graphicsFamily;
+	barrier.image = job.image;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.baseMipLevel = 0;
+	barrier.subresourceRange.levelCount = job.levels;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = 1;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = 0;
+
+	vkCmdPipelineBarrier( record(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier );
+
+	barrier.srcAccessMask = 0;
+	barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+	imageAcquires.push_back( barrier );
+	acquireStages |= VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+	mipmapJobs.push_back( job );
+}
+
+//https://vulkan-tutorial.com/Generating_Mipmaps
+//every level is blitted from the one above it, which is then done and moves to SHADER_READ_ONLY_OPTIMAL
+void MemoryFactory::recordMipmaps( VkCommandBuffer cmdBuffer, const MipmapJob& job )
+{
+	VkImageMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = job.image;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = 1;
+
+	int32_t width = static_cast<int32_t>(job.width);
+	int32_t height = static_cast<int32_t>(job.height);
+
+	for (uint32_t level = 1; level < job.levels; level++)
+	{
+		barrier.subresourceRange.baseMipLevel = level - 1;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+		vkCmdPipelineBarrier( cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier );
+
+		int32_t nextWidth = max( width / 2, 1 );
+		int32_t nextHeight = max( height / 2, 1 );
+
+		VkImageBlit blit = {};
+		blit.srcOffsets[0] = { 0, 0, 0 };
+		blit.srcOffsets[1] = { width, height, 1 };
+		blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		blit.srcSubresource.mipLevel = level - 1;
+		blit.srcSubresource.baseArrayLayer = 0;
+		blit.srcSubresource.layerCount = 1;
+		blit.dstOffsets[0] = { 0, 0, 0 };
+		blit.dstOffsets[1] = { nextWidth, nextHeight, 1 };
+		blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		blit.dstSubresource.mipLevel = level;
+		blit.dstSubresource.baseArrayLayer = 0;
+		blit.dstSubresource.layerCount = 1;
+
+		vkCmdBlitImage( cmdBuffer,
+			job.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			job.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			1, &blit, VK_FILTER_LINEAR );
+
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+		vkCmdPipelineBarrier( cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier );
+
+		width = nextWidth;
+		height = nextHeight;
+	}
+
+	//the last level is only ever written
+	barrier.subresourceRange.baseMipLevel = job.levels - 1;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+	vkCmdPipelineBarrier( cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier );
+}
+
+bool MemoryFactory::supportsLinearBlit( VkFormat format )
+{
+	VkFormatProperties formatProps;
+	vkGetPhysicalDeviceFormatProperties( physicalDevice, format, &formatProps );
+
+	VkFormatFeatureFlags needed = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+	return (formatProps.optimalTilingFeatures & needed) == needed;
+}
+
+bool MemoryFactory::supportsSampling( VkFormat format )
+{
+	VkFormatProperties formatProps;
+	vkGetPhysicalDeviceFormatProperties( physicalDevice, format, &formatProps );
+
+	return (formatProps.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) != 0;
+}
+
+void MemoryFactory::uploadLevel( const uint8_t * pixels, VkImage image, uint32_t width, uint32_t height, uint32_t mipLevel, FormatBlock block )
+{
+	//compressed formats are copied in rows of blocks, the granularity is in blocks for them as well
+	uint32_t blockRows = (height + block.size - 1) / block.size;
+
+	//whole rows per chunk, a row that doesn't fit in the ring makes reserve throw
+	VkDeviceSize rowPitch = static_cast<VkDeviceSize>((width + block.size - 1) / block.size) * block.bytes;
+	uint32_t rowsPerChunk = static_cast<uint32_t>(max<VkDeviceSize>( getChunkSize() / rowPitch, 1 ));
+
+	//transfer-only queues can require copies aligned to a granularity, families that only copy whole images are never picked
+	if (copyGranularity.height > 1)
+	{
+		rowsPerChunk = max( rowsPerChunk / copyGranularity.height, 1u ) * copyGranularity.height;
+	}
+
+	for (uint32_t row = 0; row < blockRows; row += rowsPerChunk)
+	{
+		uint32_t rows = min( rowsPerChunk, blockRows - row );
+
+		StagingRegion region = reserveStaging( rows * rowPitch );
+		memcpy( region.mapped, pixels + row * rowPitch, (size_t)region.size );
+
+		//the last block row may reach past the edge of the level, the copy extent stops at the edge
+		uint32_t y = row * block.size;
+		copyBufferToImage( region.buffer, image, width, min( rows * block.size, height - y ), region.offset, y, mipLevel );
+	}
+}
+
+StagingRegion MemoryFactory::reserveStaging( VkDeviceSize size )
+{
+	StagingRegion region;
+
+	if (!stagingRing->tryReserve( size, 16, region ))
+	{
+		//the open batch alone fills the ring, send it off early so its space can be recycled
+		submitRecorded();
+		region = stagingRing->reserve( size );
+	}
+
+	return region;
+}
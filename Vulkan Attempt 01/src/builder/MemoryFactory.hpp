@@ -1,12 +1,25 @@
 #pragma once
 
 #include <vulkan/vulkan.h>
+#include <deque>
 #include "../util/Util.hpp"
+#include "../memory/MemoryAllocator.hpp"
+#include "../memory/StagingRing.hpp"
+#include "../profiling/CpuProfiler.hpp"
+#include "../CommandBufferAllocator.hpp"
+#include "../texture/TextureFile.hpp"
+#include "../texture/BlockDecoder.hpp"
 
 using namespace std;
 
 namespace com::gelunox::vulcanUtils
 {
+	//identifies a submitted upload batch, serial 0 is always complete
+	struct UploadTicket
+	{
+		uint64_t serial = 0;
+	};
+
 	class MemoryFactory
 	{
 	private:
@@ -16,6 +29,50 @@ namespace com::gelunox::vulcanUtils
 		VkCommandPool commandPool;
 		VkQueue copyQueue;
 
+		//when the copy queue is from another family resources are released there and acquired on the graphics queue
+		VkCommandPool graphicsPool;
+		VkQueue graphicsQueue;
+		uint32_t copyFamily = 0;
+		uint32_t graphicsFamily = 0;
+		VkExtent3D copyGranularity = { 1, 1, 1 };
+
+		MemoryAllocator * allocator;
+		StagingRing * stagingRing;
+
+		//everything recorded until the next submit lands in this commandbuffer
+		VkCommandBuffer batchBuffer = VK_NULL_HANDLE;
+		bool batchOpen = false;
+		uint64_t lastSerial = 0;
+
+		struct Submission
+		{
+			uint64_t serial;
+			VkCommandBuffer copy;
+			VkCommandBuffer acquire;
+			VkSemaphore copied;
+		};
+		deque<Submission> submissions;
+		vector<VkSemaphore> freeSemaphores;
+		//finished buffers are reset and recorded again instead of freed, the pools have RESET_COMMAND_BUFFER
+		vector<VkCommandBuffer> freeCopyBuffers;
+		vector<VkCommandBuffer> freeAcquireBuffers;
+		CommandBufferStats commandBufferStats;
+
+		//acquire halves of the ownership transfers released in the open commandbuffer
+		vector<VkBufferMemoryBarrier> bufferAcquires;
+		vector<VkImageMemoryBarrier> imageAcquires;
+		VkPipelineStageFlags acquireStages = 0;
+
+		//blits need a graphics queue, with an ownership transfer they are recorded after the acquire
+		struct MipmapJob
+		{
+			VkImage image;
+			uint32_t width;
+			uint32_t height;
+			uint32_t levels;
+		};
+		vector<MipmapJob> mipmapJobs;
+
 	public:
 		MemoryFactory();
 		~MemoryFactory();
@@ -24,16 +81,69 @@ namespace com::gelunox::vulcanUtils
 		void setLogicalDevice( VkDevice& logicalDevice ) { this->logicalDevice = logicalDevice; }
 		void setCommandPool( VkCommandPool& commandPool ) { this->commandPool = commandPool; }
 		void setBufferCopyQueue( VkQueue& copyQueue ) { this->copyQueue = copyQueue; }
+		void setGraphicsQueue( VkQueue& graphicsQueue ) { this->graphicsQueue = graphicsQueue; }
+		void setGraphicsCommandPool( VkCommandPool& graphicsPool ) { this->graphicsPool = graphicsPool; }
+		void setQueueFamilies( uint32_t copyFamily, uint32_t graphicsFamily );
+		void setAllocator( MemoryAllocator * allocator ) { this->allocator = allocator; }
+		void setStagingRing( StagingRing * stagingRing ) { this->stagingRing = stagingRing; }
+
+		//uploads between beginBatch and submitBatch share one commandbuffer and one submit
+		//outside of a batch every upload is submitted and waited for on its own
+		void beginBatch();
+		UploadTicket submitBatch();
+		bool isComplete( UploadTicket ticket );
+		void wait( UploadTicket ticket );
+		//waits for everything that was submitted, call before the pools and device are destroyed
+		void releaseUploadResources();
+		const CommandBufferStats& getCommandBufferStats() { return commandBufferStats; }
 
-		void createTextureImage( char * location, VkImage& dstImage, VkDeviceMemory& dstMemory );
-		void transitionImageLayout( VkImage & image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout );
-		void copyBufferToImage( VkBuffer & buffer, VkImage & image, uint32_t width, uint32_t height );
+		//images get the full mip chain, blitted on the gpu when the format can be filtered linearly and downsampled on the cpu otherwise
+		//.ktx2 and .dds files keep their own chain and block compressed format, decoded on the cpu when the device can't sample it
+		void createTextureImage( const char * location, VkImage& dstImage, Allocation& dstMemory, uint32_t& mipLevels, VkFormat& format );
+		//for files decoded elsewhere, e.g. on a TextureStreamer worker
+		void createTextureImage( const TextureFile& file, VkImage& dstImage, Allocation& dstMemory, uint32_t& mipLevels, VkFormat& format );
+		void transitionImageLayout( VkImage & image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t levelCount = 1 );
+		void copyBufferToImage( VkBuffer & buffer, VkImage & image, uint32_t width, uint32_t height, VkDeviceSize bufferOffset = 0, int32_t y = 0,
+			uint32_t mipLevel = 0 );
 
-		void createBufferMemory( VkDeviceSize size, void const * srcData, VkBuffer & dstBuffer, VkDeviceMemory & dstMemory, VkBufferUsageFlagBits flags );
-		void createBuffer( VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags property, VkBuffer & buffer, VkDeviceMemory & memory );
-		void copyBuffer( VkBuffer src, VkBuffer dst, VkDeviceSize size );
+		void createBufferMemory( VkDeviceSize size, void const * srcData, VkBuffer & dstBuffer, Allocation & dstMemory, VkBufferUsageFlagBits flags );
+		//for device local buffers that are filled in parts, e.g. a GeometryArena, the gpu must not be reading the range yet
+		void uploadToBuffer( VkDeviceSize size, void const * srcData, VkBuffer dstBuffer, VkDeviceSize dstOffset, VkBufferUsageFlags usage );
+		void createBuffer( VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags property, VkBuffer & buffer, Allocation & memory );
+		void destroyBuffer( VkBuffer & buffer, Allocation & memory );
+		void destroyImage( VkImage & image, Allocation & memory );
+		void copyBuffer( VkBuffer src, VkBuffer dst, VkDeviceSize size, VkDeviceSize srcOffset = 0, VkDeviceSize dstOffset = 0 );
 
 		VkCommandBuffer beginOneTimeUsageCommand();
-		void endOneTimeUsageCommand( VkCommandBuffer & cmdBuffer );
+
+	private:
+		bool hasOwnershipTransfer() { return copyFamily != graphicsFamily; }
+
+		VkCommandBuffer beginOneTimeUsageCommand( VkCommandPool pool, vector<VkCommandBuffer>& recycled );
+		VkCommandBuffer record();
+		void endRecord();
+		void submitRecorded();
+		void freeFinishedBuffers();
+		VkSemaphore getSemaphore();
+
+		//makes a finished upload visible to the graphics queue, including the ownership transfer if there is one
+		//only the uploaded range changes owner, the rest of the buffer may still be written on the copy queue
+		void releaseBuffer( VkBuffer buffer, VkBufferUsageFlags usage, VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE );
+		void releaseImage( VkImage image, uint32_t levelCount = 1 );
+		//like releaseImage, but level 0 is blitted down the chain first
+		void releaseForMipmaps( const MipmapJob& job );
+		void recordMipmaps( VkCommandBuffer cmdBuffer, const MipmapJob& job );
+		bool supportsLinearBlit( VkFormat format );
+		bool supportsSampling( VkFormat format );
+		//staged in chunks of whole rows, the level has to be in TRANSFER_DST_OPTIMAL
+		void uploadLevel( const uint8_t * pixels, VkImage image, uint32_t width, uint32_t height, uint32_t mipLevel, FormatBlock block = { 4, 1 } );
+		void createMipmappedImage( const TextureFile& file, VkImage& dstImage, Allocation& dstMemory, uint32_t& mipLevels, VkFormat& format );
+		void createContainerImage( const TextureFile& file, VkImage& dstImage, Allocation& dstMemory, uint32_t& mipLevels, VkFormat& format );
+		void createSampledImage( uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageUsageFlags extraUsage,
+			VkImage& image, Allocation& memory );
+		StagingRegion reserveStaging( VkDeviceSize size );
+
+		//uploads are split so the next chunk can be written while the previous one is copied
+		VkDeviceSize getChunkSize() { return stagingRing->getCapacity() / 2; }
 	};
 };
\ No newline at end of file
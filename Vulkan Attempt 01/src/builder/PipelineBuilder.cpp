@@ -7,9 +7,16 @@ typedef PipelineBuilder::This This;
 PipelineBuilder::PipelineBuilder( VkDevice & device ) : device( device )
 {
 	//vertices
+	auto vertexAttributes = PackedVertex::getAttributeDescriptions();
+	auto instanceAttributes = InstanceData::getAttributeDescriptions();
+
+	bindDescriptions = { PackedVertex::getBindDescription(), InstanceData::getBindDescription() };
+	attributeDescriptions.insert( attributeDescriptions.end(), vertexAttributes.begin(), vertexAttributes.end() );
+	attributeDescriptions.insert( attributeDescriptions.end(), instanceAttributes.begin(), instanceAttributes.end() );
+
 	vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-	vertexInputInfo.vertexBindingDescriptionCount = 1;
-	vertexInputInfo.pVertexBindingDescriptions = &bindDescription;
+	vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindDescriptions.size());
+	vertexInputInfo.pVertexBindingDescriptions = bindDescriptions.data();
 	vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
 	vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
 
@@ -18,19 +25,12 @@ PipelineBuilder::PipelineBuilder( VkDevice & device ) : device( device )
 	inputAssInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
 	inputAssInfo.primitiveRestartEnable = VK_FALSE;
 
-	//viewport
-	viewport.x = 0.0f;
-	viewport.y = 0.0f;
-	viewport.minDepth = 0.0f;
-	viewport.maxDepth = 0.0f;
-
-	scissor.offset = { 0, 0 };
-
+	//viewport, the actual rectangles are dynamic state
 	viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
 	viewportState.viewportCount = 1;
-	viewportState.pViewports = &viewport;
+	viewportState.pViewports = nullptr;
 	viewportState.scissorCount = 1;
-	viewportState.pScissors = &scissor;
+	viewportState.pScissors = nullptr;
 
 	//rasterizer
 	rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
@@ -76,11 +76,9 @@ PipelineBuilder::PipelineBuilder( VkDevice & device ) : device( device )
 	colorblending.blendConstants[3] = 0.0f;
 
 	//dynamic state
-	VkDynamicState dynamicStates[] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_LINE_WIDTH };
-
-	//dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-	//dynamicState.dynamicStateCount = 2;
-	//dynamicState.pDynamicStates = dynamicStates;
+	dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+	dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+	dynamicState.pDynamicStates = dynamicStates.data();
 
 	pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
 	pipelineInfo.pVertexInputState = &vertexInputInfo;
@@ -90,7 +88,7 @@ PipelineBuilder::PipelineBuilder( VkDevice & device ) : device( device )
 	pipelineInfo.pMultisampleState = &multisampling;
 	pipelineInfo.pDepthStencilState = nullptr;
 	pipelineInfo.pColorBlendState = &colorblending;
-	//pipelineInfo.pDynamicState = &dynamicState;
+	pipelineInfo.pDynamicState = &dynamicState;
 	pipelineInfo.subpass = 0;
 	pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 	pipelineInfo.basePipelineIndex = -1;
@@ -104,9 +102,9 @@ PipelineBuilder::~PipelineBuilder()
 	}
 }
 
-This PipelineBuilder::addShaderStage( vector<char>& data, const char* name, VkShaderStageFlagBits stage )
+This PipelineBuilder::addShaderStage( const AssetData& code, const char* name, VkShaderStageFlagBits stage )
 {
-	VkShaderModule module = createShaderModule( device, data );
+	VkShaderModule module = createShaderModule( device, code );
 
 	VkPipelineShaderStageCreateInfo stageInfo = {};
 	stageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -122,16 +120,6 @@ This PipelineBuilder::addShaderStage( vector<char>& data, const char* name, VkSh
 	return *this;
 }
 
-This PipelineBuilder::setImageExtent( VkExtent2D& imageExtent )
-{
-	viewport.width = (float)imageExtent.width;
-	viewport.height = (float)imageExtent.height;
-
-	scissor.extent = imageExtent;
-
-	return *this;
-}
-
 This PipelineBuilder::setPipelineLayout( VkPipelineLayout& layout )
 {
 	pipelineInfo.layout = layout;
@@ -146,11 +134,18 @@ This PipelineBuilder::setRenderPass( VkRenderPass& renderPass )
 	return *this;
 }
 
+This PipelineBuilder::setPipelineCache( VkPipelineCache cache )
+{
+	this->cache = cache;
+
+	return *this;
+}
+
 VkPipeline PipelineBuilder::build()
 {
 	VkPipeline pipeline;
 
-	VkResult result = vkCreateGraphicsPipelines( device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline );
+	VkResult result = vkCreateGraphicsPipelines( device, cache, 1, &pipelineInfo, nullptr, &pipeline );
 
 	if (result != VK_SUCCESS)
 	{
@@ -160,7 +155,7 @@ VkPipeline PipelineBuilder::build()
 	return pipeline;
 }
 
-VkShaderModule PipelineBuilder::createShaderModule( VkDevice& device, const vector<char>& code )
+VkShaderModule PipelineBuilder::createShaderModule( VkDevice& device, const AssetData& code )
 {
 	VkShaderModuleCreateInfo createInfo = {};
 	createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
@@ -4,6 +4,8 @@
 
 #include "../util/Util.hpp"
 #include "../Vertex.hpp"
+#include "../InstanceData.hpp"
+#include "../asset/AssetData.hpp"
 
 using namespace std;
 
@@ -15,22 +17,24 @@ namespace com::gelunox::vulcanUtils
 		typedef PipelineBuilder & This;
 
 	private:
-		VkVertexInputBindingDescription bindDescription = Vertex::getBindDescription();
-		array<VkVertexInputAttributeDescription, 3> attributeDescriptions = Vertex::getAttributeDescriptions();
+		//per vertex data on binding 0, per instance data on binding 1
+		vector<VkVertexInputBindingDescription> bindDescriptions;
+		vector<VkVertexInputAttributeDescription> attributeDescriptions;
 		
 		VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
 		VkPipelineInputAssemblyStateCreateInfo inputAssInfo = {};
-		VkViewport viewport = {};
-		VkRect2D scissor = {};
 		VkPipelineViewportStateCreateInfo viewportState = {};
 		VkPipelineRasterizationStateCreateInfo rasterizer = {};
 		VkPipelineMultisampleStateCreateInfo multisampling = {};
 		VkPipelineColorBlendAttachmentState colorblendAttachment = {};
 		VkPipelineColorBlendStateCreateInfo colorblending = {};
+		//viewport and scissor are set while recording, so a resize doesn't need a new pipeline
+		vector<VkDynamicState> dynamicStates = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
 		VkPipelineDynamicStateCreateInfo dynamicState = {};
 		VkGraphicsPipelineCreateInfo pipelineInfo = {};
 
 		VkDevice device;
+		VkPipelineCache cache = VK_NULL_HANDLE;
 
 		vector<VkShaderModule> shaderModules;
 		vector<VkPipelineShaderStageCreateInfo> shaderStages;
@@ -38,14 +42,15 @@ namespace com::gelunox::vulcanUtils
 		PipelineBuilder(VkDevice & device);
 		~PipelineBuilder();
 
-		This addShaderStage( vector<char>& data, const char* name, VkShaderStageFlagBits stage );
+		//the module is created right away, code only has to live until this returns
+		This addShaderStage( const AssetData& code, const char* name, VkShaderStageFlagBits stage );
 
-		This setImageExtent( VkExtent2D& imageExtent );
 		This setPipelineLayout( VkPipelineLayout& layout );
 		This setRenderPass( VkRenderPass& renderPass );
+		This setPipelineCache( VkPipelineCache cache );
 		VkPipeline build();
 
 	private:
-		VkShaderModule createShaderModule( VkDevice& device, const vector<char>& code );
+		VkShaderModule createShaderModule( VkDevice& device, const AssetData& code );
 	};
 };
\ No newline at end of file
@@ -24,6 +24,20 @@ This PipelineLayoutBuilder::addDescriptorSetLayout( VkDescriptorSetLayout & layo
 	return *this;
 }
 
+This PipelineLayoutBuilder::addPushConstantRange( VkShaderStageFlags stages, uint32_t offset, uint32_t size )
+{
+	VkPushConstantRange range = {};
+	range.stageFlags = stages;
+	range.offset = offset;
+	range.size = size;
+
+	pushConstantRanges.push_back( range );
+
+	pipelineLayoutInfo.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size());
+	pipelineLayoutInfo.pPushConstantRanges = pushConstantRanges.data();
+	return *this;
+}
+
 VkPipelineLayout PipelineLayoutBuilder::build()
 {
 	VkPipelineLayout layout;
@@ -18,10 +18,14 @@ namespace com::gelunox::vulcanUtils
 		VkDevice device;
 
 		vector<VkDescriptorSetLayout> descriptorSetLayouts;
+		vector<VkPushConstantRange> pushConstantRanges;
 	public:
 		PipelineLayoutBuilder(VkDevice & device);
 
+		//set numbers follow the order the layouts are added in
 		This addDescriptorSetLayout( VkDescriptorSetLayout & layout );
+		//offset and size are multiples of 4, 128 bytes in total is all a device has to support
+		This addPushConstantRange( VkShaderStageFlags stages, uint32_t offset, uint32_t size );
 
 		VkPipelineLayout build();
 	};
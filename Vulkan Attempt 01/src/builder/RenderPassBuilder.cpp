@@ -46,6 +46,13 @@ This RenderPassBuilder::setImageFormat( VkFormat& imageFormat )
 	return *this;
 }
 
+//PRESENT_SRC_KHR by default, images that are never presented can't use it
+This RenderPassBuilder::setFinalLayout( VkImageLayout layout )
+{
+	colorAttachment.finalLayout = layout;
+	return *this;
+}
+
 VkRenderPass RenderPassBuilder::build()
 {
 	VkRenderPass renderPass;
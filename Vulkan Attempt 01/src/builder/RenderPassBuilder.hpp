@@ -20,6 +20,7 @@ namespace com::gelunox::vulcanUtils
 		RenderPassBuilder( VkDevice device );
 
 		This setImageFormat( VkFormat& imageFormat );
+		This setFinalLayout( VkImageLayout layout );
 
 		VkRenderPass build();
 	private:
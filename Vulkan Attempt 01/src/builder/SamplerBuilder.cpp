@@ -1,5 +1,7 @@
 #include "SamplerBuilder.hpp"
 
+#include <stdexcept>
+
 using namespace com::gelunox::vulcanUtils;
 
 typedef SamplerBuilder::This This;
@@ -26,6 +28,19 @@ SamplerBuilder::SamplerBuilder(VkDevice& device): device(device)
 	samplerInfo.maxLod = .0f;
 }
 
+This SamplerBuilder::setAnisotropy( VkBool32 enabled, float maxAnisotropy )
+{
+	samplerInfo.anisotropyEnable = enabled;
+	samplerInfo.maxAnisotropy = enabled ? maxAnisotropy : 1.0f;
+	return *this;
+}
+
+This SamplerBuilder::setMipLevels( uint32_t levelCount )
+{
+	samplerInfo.maxLod = static_cast<float>(levelCount - 1);
+	return *this;
+}
+
 VkSampler SamplerBuilder::build()
 {
 	VkSampler sampler;
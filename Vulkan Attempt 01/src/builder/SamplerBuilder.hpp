@@ -18,6 +18,11 @@ namespace com::gelunox::vulcanUtils
 	public:
 		SamplerBuilder(VkDevice& device);
 
+		//enabled by default, needs the samplerAnisotropy device feature
+		This setAnisotropy( VkBool32 enabled, float maxAnisotropy );
+		//lets lod select from every level of the image, the default of 1 only ever samples level 0
+		This setMipLevels( uint32_t levelCount );
+
 		VkSampler build();
 	};
 
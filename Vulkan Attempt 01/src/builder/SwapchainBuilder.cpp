@@ -1,5 +1,7 @@
 #include "SwapchainBuilder.hpp"
 
+#include <stdexcept>
+
 using namespace com::gelunox::vulcanUtils;
 
 typedef SwapchainBuilder::This This;
@@ -49,7 +51,7 @@ This SwapchainBuilder::addQueueFamily( uint32_t& index )
 	return *this;
 }
 
-This SwapchainBuilder::addQueueFamilies( vector<uint32_t>& indices )
+This SwapchainBuilder::addQueueFamilies( const vector<uint32_t>& indices )
 {
 	for(uint32_t index: indices)
 		queueFamilyIndices.insert( index );
@@ -1,25 +1,268 @@
 #include "VulkanWindow.hpp"
+#include "asset/AssetPack.hpp"
+#include "mesh/MeshImporter.hpp"
+#include "mesh/MeshOptimizer.hpp"
+#include "mesh/MeshFile.hpp"
 
 #include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <filesystem>
+#include <limits>
+#include <stdexcept>
 
 using namespace com::gelunox::vulcanUtils;
 
-int main()
+//spir-v shrinks well with lz4, the textures are stored as they are so they load without a copy
+static void packAssets( const string& path )
 {
+	AssetPackWriter writer;
+
+	for (const auto& file : filesystem::directory_iterator( "shaders" ))
+	{
+		if (file.is_regular_file() && file.path().extension() == ".spv")
+		{
+			writer.add( "shaders/" + file.path().filename().string(), file.path().string(), true );
+		}
+	}
+
+	for (const auto& file : filesystem::directory_iterator( "textures" ))
+	{
+		if (file.is_regular_file())
+		{
+			writer.add( "textures/" + file.path().filename().string(), file.path().string(), false );
+		}
+	}
+
+	for (const auto& file : filesystem::directory_iterator( "models" ))
+	{
+		if (file.is_regular_file() && file.path().extension() == ".mesh")
+		{
+			writer.add( "models/" + file.path().filename().string(), file.path().string(), false );
+		}
+	}
+
+	writer.write( path );
+	std::cout << "wrote " << path << std::endl;
+}
+
+//cache misses per triangle over all meshes, each mesh starts with a cold cache
+static float getCacheMissRatio( const MeshData& mesh )
+{
+	double misses = 0.0;
+
+	for (size_t i = 0; i < mesh.meshes.size(); i++)
+	{
+		const Mesh& range = mesh.meshes[i];
+		misses += MeshOptimizer::getAverageCacheMissRatio( mesh.indices.data() + range.firstIndex, range.indexCount, mesh.vertexCounts[i] ) * (range.indexCount / 3);
+	}
+
+	return mesh.indices.empty() ? 0.0f : static_cast<float>(misses / (mesh.indices.size() / 3));
+}
+
+//a whole decimal number that fits in 32 bits, stoul alone would accept a sign, trailing text and 64 bit values
+static uint32_t parseCount( const char * value )
+{
+	if (*value < '0' || *value > '9')
+	{
+		throw invalid_argument( "not a count: " + string( value ) );
+	}
+
+	size_t used;
+	unsigned long long count = std::stoull( value, &used );
+
+	if (value[used] != '\0')
+	{
+		throw invalid_argument( "not a count: " + string( value ) );
+	}
+	if (count > numeric_limits<uint32_t>::max())
+	{
+		throw out_of_range( "count too large: " + string( value ) );
+	}
+
+	return static_cast<uint32_t>(count);
+}
+
+static void printUsage( const char * program )
+{
+	std::cerr << "usage: " << program << " [--headless] [--trace] [--stats] [--frames N] [--objects N] [--fps N] [--instanced] [--no-culling]" << std::endl
+		<< "       " << program << " --pack-assets" << std::endl
+		<< "       " << program << " --cook-mesh IN OUT" << std::endl;
+}
+
+//acmr is the average of cache misses per triangle, reported for a 16 entry fifo like most hardware has
+static void cookMesh( const string& source, const string& target )
+{
+	MeshData mesh = MeshImporter::import( source );
+
+	float before = getCacheMissRatio( mesh );
+	MeshOptimizer::optimize( mesh );
+	float after = getCacheMissRatio( mesh );
+
+	MeshFile::write( mesh, target );
+	std::cout << "wrote " << target << ": " << mesh.meshes.size() << " meshes, " << mesh.vertices.size() << " vertices of " << sizeof( PackedVertex ) << " bytes, "
+		<< mesh.indices.size() / 3 << " triangles, acmr " << before << " -> " << after << std::endl;
+}
+
+//--headless renders offscreen without a window, --frames N stops after N frames and reports frame times
+//--trace records cpu scopes and writes them to trace.json at exit
+//--stats prints the pacing, gpu, memory and command buffer reports at exit, always on for benchmarks
+//--objects N draws a grid of N quads, --instanced draws them without the indirect buffer
+//--fps N starts frames on a fixed cadence of N per second, by default the present mode paces the frames
+//--no-culling fills the indirect buffer on the cpu instead of culling on the gpu
+//--pack-assets writes the shaders, textures and meshes to assets.pack and exits, later runs load from it
+//--cook-mesh IN OUT imports an .obj, .gltf or .glb, optimises it and writes the .mesh the renderer loads, then exits
+int main( int argc, char ** argv )
+{
+	bool headless = false;
+	bool trace = false;
+	bool stats = false;
+	uint32_t frames = 0;
+	uint32_t objects = 1;
+	uint32_t fps = 0;
+	bool instanced = false;
+	bool culling = true;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp( argv[i], "--headless" ) == 0)
+		{
+			headless = true;
+		}
+		else if (strcmp( argv[i], "--trace" ) == 0)
+		{
+			trace = true;
+		}
+		else if (strcmp( argv[i], "--stats" ) == 0)
+		{
+			stats = true;
+		}
+		else if (strcmp( argv[i], "--frames" ) == 0 || strcmp( argv[i], "--objects" ) == 0 || strcmp( argv[i], "--fps" ) == 0)
+		{
+			if (i + 1 >= argc)
+			{
+				std::cerr << argv[i] << ": missing count" << std::endl;
+				printUsage( argv[0] );
+				return 1;
+			}
+
+			uint32_t count;
+
+			try
+			{
+				count = parseCount( argv[i + 1] );
+			}
+			catch (const exception& e)
+			{
+				std::cerr << argv[i] << ": " << e.what() << std::endl;
+				printUsage( argv[0] );
+				return 1;
+			}
+
+			if (strcmp( argv[i], "--frames" ) == 0)
+			{
+				frames = count;
+			}
+			else if (strcmp( argv[i], "--objects" ) == 0)
+			{
+				objects = count;
+			}
+			else
+			{
+				fps = count;
+			}
+			i++;
+		}
+		else if (strcmp( argv[i], "--instanced" ) == 0)
+		{
+			instanced = true;
+		}
+		else if (strcmp( argv[i], "--no-culling" ) == 0)
+		{
+			culling = false;
+		}
+		else if (strcmp( argv[i], "--pack-assets" ) == 0)
+		{
+			try
+			{
+				packAssets( "assets.pack" );
+			}
+			catch (const exception& e)
+			{
+				std::cerr << e.what() << std::endl;
+				return 1;
+			}
+			return 0;
+		}
+		else if (strcmp( argv[i], "--cook-mesh" ) == 0)
+		{
+			if (i + 2 >= argc)
+			{
+				std::cerr << argv[i] << ": needs an input and an output file" << std::endl;
+				printUsage( argv[0] );
+				return 1;
+			}
+
+			try
+			{
+				cookMesh( argv[i + 1], argv[i + 2] );
+			}
+			catch (const exception& e)
+			{
+				std::cerr << e.what() << std::endl;
+				return 1;
+			}
+			return 0;
+		}
+		else
+		{
+			std::cerr << "unknown argument: " << argv[i] << std::endl;
+			printUsage( argv[0] );
+			return 1;
+		}
+	}
+
+	//without a window nothing else ends the run
+	if (headless && frames == 0)
+	{
+		frames = 1000;
+	}
+
+	CpuProfiler::setEnabled( trace );
+	int exitCode = 0;
+
 	try {
 		{
-			VulkanWindow window;
+			VulkanWindow window( 2, headless, stats || headless || frames > 0 );
+			window.setObjectCount( objects );
+			window.setDrawMode( instanced ? DrawMode::INSTANCED : culling ? DrawMode::CULLED : DrawMode::INDIRECT );
+
+			if (fps > 0)
+			{
+				window.getFramePacer().setMode( PacingMode::TARGET_FPS, fps );
+			}
 
-			window.run();
+			window.run( frames );
 		}
 	}
-	catch (runtime_error e)
+	catch (const exception& e)
 	{
 		std::cerr << e.what() << std::endl;
+		exitCode = 1;
 	}
 
-	std::cout << "Press enter to continue...";
-	getchar();
+	if (trace)
+	{
+		CpuProfiler::writeChromeTrace( "trace.json" );
+	}
+
+	//benchmarks run unattended
+	if (!headless)
+	{
+		std::cout << "Press enter to continue...";
+		getchar();
+	}
 
-	return 0;
+	return exitCode;
 }
@@ -0,0 +1,75 @@
+#include "FrameUniformBuffer.hpp"
+
+#include "../util/Util.hpp"
+
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+
+using namespace com::gelunox::vulcanUtils;
+using namespace std;
+
+FrameUniformBuffer::FrameUniformBuffer( VkPhysicalDevice physicalDevice, VkDevice device, MemoryAllocator * allocator, VkDeviceSize regionSize, uint32_t frameCount,
+	VkBufferUsageFlags usage )
+	: device( device ), allocator( allocator ), regionSize( regionSize ), frameCount( frameCount )
+{
+	VkPhysicalDeviceProperties deviceProps;
+	vkGetPhysicalDeviceProperties( physicalDevice, &deviceProps );
+
+	//flushes work on whole atoms, so regions are padded to those as well to never flush a neighbouring frame
+	VkDeviceSize alignment = max( deviceProps.limits.minUniformBufferOffsetAlignment, deviceProps.limits.nonCoherentAtomSize );
+	if (usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+	{
+		alignment = max( alignment, deviceProps.limits.minStorageBufferOffsetAlignment );
+	}
+	stride = Util::alignUp( regionSize, alignment );
+
+	VkBufferCreateInfo bufferInfo = {};
+	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size = stride * frameCount;
+	bufferInfo.usage = usage;
+	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	if (vkCreateBuffer( device, &bufferInfo, nullptr, &buffer ) != VK_SUCCESS)
+	{
+		throw runtime_error( "Error creating uniform buffer" );
+	}
+
+	VkMemoryRequirements memReq;
+	vkGetBufferMemoryRequirements( device, buffer, &memReq );
+	memReq.alignment = max( memReq.alignment, deviceProps.limits.nonCoherentAtomSize );
+
+	//whichever host visible type comes first, coherency is handled below
+	memory = allocator->allocate( memReq, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, ResourceKind::LINEAR );
+	vkBindBufferMemory( device, buffer, memory.memory, memory.offset );
+
+	coherent = (memory.properties & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+}
+
+FrameUniformBuffer::~FrameUniformBuffer()
+{
+	vkDestroyBuffer( device, buffer, nullptr );
+	allocator->free( memory );
+}
+
+void FrameUniformBuffer::write( uint32_t frameIndex, const void * data, VkDeviceSize size )
+{
+	if (frameIndex >= frameCount || size > regionSize)
+	{
+		throw out_of_range( "write outside of the frame's region" );
+	}
+
+	VkDeviceSize offset = stride * frameIndex;
+	memcpy( static_cast<char*>(memory.mapped) + offset, data, (size_t)size );
+
+	if (!coherent)
+	{
+		VkMappedMemoryRange range = {};
+		range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+		range.memory = memory.memory;
+		range.offset = memory.offset + offset;
+		range.size = stride;
+
+		vkFlushMappedMemoryRanges( device, 1, &range );
+	}
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include "MemoryAllocator.hpp"
+
+using namespace std;
+
+namespace com::gelunox::vulcanUtils
+{
+	//one uniform buffer with a region per frame in flight, bound once as a dynamic uniform buffer
+	//the memory stays mapped for the lifetime of the object, non coherent memory is flushed per written region
+	//other usages stream per frame data the same way, e.g. instance data bound at getDynamicOffset
+	class FrameUniformBuffer
+	{
+	private:
+		VkDevice device;
+		MemoryAllocator * allocator;
+
+		VkBuffer buffer;
+		Allocation memory;
+
+		VkDeviceSize regionSize;
+		VkDeviceSize stride;
+		uint32_t frameCount;
+
+		bool coherent;
+
+	public:
+		FrameUniformBuffer( VkPhysicalDevice physicalDevice, VkDevice device, MemoryAllocator * allocator, VkDeviceSize regionSize, uint32_t frameCount,
+			VkBufferUsageFlags usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT );
+		~FrameUniformBuffer();
+
+		void write( uint32_t frameIndex, const void * data, VkDeviceSize size );
+
+		VkBuffer getBuffer() { return buffer; }
+		//range of the descriptor, the same for every frame
+		VkDeviceSize getRegionSize() { return regionSize; }
+		uint32_t getDynamicOffset( uint32_t frameIndex ) { return static_cast<uint32_t>(stride * frameIndex); }
+	};
+}
@@ -0,0 +1,72 @@
+#include "GeometryArena.hpp"
+
+#include <stdexcept>
+
+using namespace com::gelunox::vulcanUtils;
+using namespace std;
+
+GeometryArena::GeometryArena( MemoryFactory& memFac, uint32_t vertexCapacity, uint32_t indexCapacity, uint32_t maxMeshVertices )
+	: memFac( memFac ), vertexCapacity( vertexCapacity ), indexCapacity( indexCapacity )
+{
+	//0xffff is left out, it would be the restart index if primitive restart was ever enabled
+	indexType = maxMeshVertices <= 0xffff ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+	indexSize = indexType == VK_INDEX_TYPE_UINT16 ? sizeof( uint16_t ) : sizeof( uint32_t );
+
+	//the stride keeps the index region aligned to the index size, bind offsets have to be
+	indexOffset = VkDeviceSize( vertexCapacity ) * sizeof( PackedVertex );
+
+	memFac.createBuffer( indexOffset + indexCapacity * indexSize,
+		VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+		buffer, memory );
+}
+
+GeometryArena::~GeometryArena()
+{
+	memFac.destroyBuffer( buffer, memory );
+}
+
+uint32_t GeometryArena::add( const MeshFile& file )
+{
+	if (file.getVertexCount() > vertexCapacity - vertexCount || file.getIndexCount() > indexCapacity - indexCount)
+	{
+		throw runtime_error( "geometry arena is full" );
+	}
+
+	for (uint32_t count : file.vertexCounts)
+	{
+		if (indexType == VK_INDEX_TYPE_UINT16 && count > 0xffff)
+		{
+			throw runtime_error( "mesh has too many vertices for the geometry arena's 16 bit indices" );
+		}
+	}
+
+	memFac.uploadToBuffer( file.getVertexCount() * sizeof( PackedVertex ), file.getVertices(),
+		buffer, vertexCount * sizeof( PackedVertex ), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT );
+
+	VkDeviceSize dstOffset = indexOffset + indexCount * indexSize;
+
+	if (indexType == VK_INDEX_TYPE_UINT16)
+	{
+		//MeshFile checked every index is below its mesh's vertex count, which is checked to fit 16 bits above
+		//the staging copy is made before uploadToBuffer returns, the narrowed indices don't have to outlive it
+		vector<uint16_t> narrowed( file.getIndices(), file.getIndices() + file.getIndexCount() );
+		memFac.uploadToBuffer( narrowed.size() * sizeof( uint16_t ), narrowed.data(), buffer, dstOffset, VK_BUFFER_USAGE_INDEX_BUFFER_BIT );
+	}
+	else
+	{
+		memFac.uploadToBuffer( file.getIndexCount() * sizeof( uint32_t ), file.getIndices(), buffer, dstOffset, VK_BUFFER_USAGE_INDEX_BUFFER_BIT );
+	}
+
+	uint32_t first = static_cast<uint32_t>(meshes.size());
+
+	for (const Mesh& mesh : file.meshes)
+	{
+		meshes.push_back( { mesh.indexCount, mesh.firstIndex + indexCount, mesh.vertexOffset + static_cast<int32_t>(vertexCount), mesh.sphere } );
+	}
+
+	vertexCount += file.getVertexCount();
+	indexCount += file.getIndexCount();
+
+	return first;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vector>
+
+#include "MemoryAllocator.hpp"
+#include "../builder/MemoryFactory.hpp"
+#include "../mesh/MeshFile.hpp"
+
+using namespace std;
+
+namespace com::gelunox::vulcanUtils
+{
+	//every mesh's vertices and indices in one device local buffer, the vertex region first and the index region after it
+	//meshes are suballocated from both regions and drawn by firstIndex and vertexOffset, so the buffer is bound once per commandbuffer
+	//ranges are handed out front to back and only freed with the arena, meshes live as long as the scene
+	class GeometryArena
+	{
+	private:
+		MemoryFactory& memFac;
+
+		VkBuffer buffer = VK_NULL_HANDLE;
+		Allocation memory;
+
+		uint32_t vertexCapacity;
+		uint32_t indexCapacity;
+		uint32_t vertexCount = 0;
+		uint32_t indexCount = 0;
+
+		VkIndexType indexType;
+		VkDeviceSize indexSize;
+		VkDeviceSize indexOffset;
+
+		vector<Mesh> meshes;
+
+	public:
+		//indices are relative to a mesh's vertexOffset, so only the largest mesh decides the index type and not the whole arena
+		//16 bit when no mesh has more than 65535 vertices, the largest one passed in maxMeshVertices
+		GeometryArena( MemoryFactory& memFac, uint32_t vertexCapacity, uint32_t indexCapacity, uint32_t maxMeshVertices );
+		~GeometryArena();
+
+		//uploads the file's meshes in the open batch, or on its own outside of one, and returns the position of its first mesh
+		//throws when the arena is full or a mesh has more vertices than the index type can address
+		uint32_t add( const MeshFile& file );
+
+		//the vertices start at offset 0
+		VkBuffer getBuffer() { return buffer; }
+		VkDeviceSize getIndexOffset() { return indexOffset; }
+		VkIndexType getIndexType() { return indexType; }
+		//ranges are relative to the arena, DrawQueue refers to them by position
+		const vector<Mesh>& getMeshes() { return meshes; }
+	};
+}
@@ -0,0 +1,333 @@
+#include "MemoryAllocator.hpp"
+
+#include "../util/Util.hpp"
+
+#include <stdexcept>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+using namespace com::gelunox::vulcanUtils;
+using namespace std;
+
+MemoryAllocator::MemoryAllocator( VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize preferredBlockSize )
+	: physicalDevice( physicalDevice ), device( device ), preferredBlockSize( preferredBlockSize )
+{
+	vkGetPhysicalDeviceMemoryProperties( physicalDevice, &memProps );
+}
+
+MemoryAllocator::~MemoryAllocator()
+{
+	for (auto& pool : pools)
+	{
+		for (auto& block : pool.second)
+		{
+			if (block->mapped)
+			{
+				vkUnmapMemory( device, block->memory );
+			}
+			vkFreeMemory( device, block->memory, nullptr );
+		}
+	}
+}
+
+Allocation MemoryAllocator::allocate( VkMemoryRequirements requirements, VkMemoryPropertyFlags properties, ResourceKind kind )
+{
+	lock_guard<mutex> guard( lock );
+
+	uint32_t memoryType = Util::findMemoryType( physicalDevice, requirements.memoryTypeBits, properties );
+	stats.lifetimeAllocations++;
+
+	//big resources would waste most of a block, give them their own memory
+	if (requirements.size > getBlockSize( memoryType ) / 2)
+	{
+		return allocateDedicated( requirements, memoryType );
+	}
+
+	Allocation allocation;
+	auto& blocks = pools[{ memoryType, kind }];
+
+	for (auto& block : blocks)
+	{
+		if (allocateFromBlock( *block, requirements, allocation ))
+		{
+			return allocation;
+		}
+	}
+
+	MemoryBlock * block = createBlock( memoryType, kind );
+
+	if (!allocateFromBlock( *block, requirements, allocation ))
+	{
+		throw runtime_error( "allocation does not fit in a fresh memory block" );
+	}
+
+	return allocation;
+}
+
+void MemoryAllocator::free( Allocation& allocation )
+{
+	if (allocation.memory == VK_NULL_HANDLE)
+	{
+		return;
+	}
+
+	lock_guard<mutex> guard( lock );
+
+	stats.allocationCount--;
+	stats.usedBytes -= allocation.size;
+
+	if (!allocation.block)
+	{
+		if (allocation.mapped)
+		{
+			vkUnmapMemory( device, allocation.memory );
+		}
+		vkFreeMemory( device, allocation.memory, nullptr );
+
+		stats.dedicatedCount--;
+		stats.reservedBytes -= allocation.size;
+
+		allocation = Allocation();
+		return;
+	}
+
+	MemoryBlock& block = *allocation.block;
+	VkDeviceSize offset = allocation.offset;
+	VkDeviceSize size = allocation.size;
+
+	//coalesce with the free ranges on either side
+	auto after = block.freeRanges.lower_bound( offset );
+	if (after != block.freeRanges.end() && after->first == offset + size)
+	{
+		size += after->second;
+		after = block.freeRanges.erase( after );
+	}
+
+	bool merged = false;
+	if (after != block.freeRanges.begin())
+	{
+		auto before = std::prev( after );
+		if (before->first + before->second == offset)
+		{
+			before->second += size;
+			merged = true;
+		}
+	}
+
+	if (!merged)
+	{
+		block.freeRanges[offset] = size;
+	}
+
+	block.allocationCount--;
+	allocation = Allocation();
+
+	if (block.allocationCount == 0)
+	{
+		//keep a single empty block per pool around so alloc/free cycles don't hit the driver
+		auto& blocks = pools[{ block.memoryType, block.kind }];
+		size_t emptyBlocks = count_if( blocks.begin(), blocks.end(), []( unique_ptr<MemoryBlock>& b ) { return b->allocationCount == 0; } );
+
+		if (emptyBlocks > 1)
+		{
+			destroyBlock( &block );
+		}
+	}
+}
+
+Allocation MemoryAllocator::allocateForBuffer( VkBuffer buffer, VkMemoryPropertyFlags properties )
+{
+	VkMemoryRequirements memReq;
+	vkGetBufferMemoryRequirements( device, buffer, &memReq );
+
+	Allocation allocation = allocate( memReq, properties, ResourceKind::LINEAR );
+	vkBindBufferMemory( device, buffer, allocation.memory, allocation.offset );
+
+	return allocation;
+}
+
+Allocation MemoryAllocator::allocateForImage( VkImage image, VkMemoryPropertyFlags properties )
+{
+	VkMemoryRequirements memReq;
+	vkGetImageMemoryRequirements( device, image, &memReq );
+
+	Allocation allocation = allocate( memReq, properties, ResourceKind::OPTIMAL );
+	vkBindImageMemory( device, image, allocation.memory, allocation.offset );
+
+	return allocation;
+}
+
+AllocatorStats MemoryAllocator::getStats()
+{
+	lock_guard<mutex> guard( lock );
+
+	return stats;
+}
+
+void MemoryAllocator::report( ostream& out )
+{
+	AllocatorStats current = getStats();
+	const double mb = 1024.0 * 1024.0;
+
+	out << "device memory: " << current.blockCount << " blocks + " << current.dedicatedCount << " dedicated"
+		<< " | reserved: " << current.reservedBytes / mb << "MB"
+		<< " | used: " << current.usedBytes / mb << "MB in " << current.allocationCount << " allocations"
+		<< " | vkAllocateMemory calls: " << current.lifetimeDeviceAllocations << " for " << current.lifetimeAllocations << " resources" << endl;
+}
+
+VkDeviceSize MemoryAllocator::getBlockSize( uint32_t memoryType )
+{
+	VkDeviceSize heapSize = memProps.memoryHeaps[memProps.memoryTypes[memoryType].heapIndex].size;
+
+	//small heaps (host visible device local windows for example) would be eaten by a few blocks
+	if (heapSize <= 1024ull * 1024 * 1024)
+	{
+		return min( preferredBlockSize, Util::alignUp( heapSize / 8, 4096 ) );
+	}
+
+	return preferredBlockSize;
+}
+
+Allocation MemoryAllocator::allocateDedicated( VkMemoryRequirements& requirements, uint32_t memoryType )
+{
+	Allocation allocation;
+	allocation.size = requirements.size;
+	allocation.memoryType = memoryType;
+	allocation.properties = memProps.memoryTypes[memoryType].propertyFlags;
+
+	VkMemoryAllocateInfo allocInfo = {};
+	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocInfo.allocationSize = requirements.size;
+	allocInfo.memoryTypeIndex = memoryType;
+
+	if (vkAllocateMemory( device, &allocInfo, nullptr, &allocation.memory ) != VK_SUCCESS)
+	{
+		throw runtime_error( "could not allocate gpu memory" );
+	}
+
+	if (allocation.properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+	{
+		vkMapMemory( device, allocation.memory, 0, VK_WHOLE_SIZE, 0, &allocation.mapped );
+	}
+
+	stats.dedicatedCount++;
+	stats.allocationCount++;
+	stats.reservedBytes += allocation.size;
+	stats.usedBytes += allocation.size;
+	stats.lifetimeDeviceAllocations++;
+
+	return allocation;
+}
+
+bool MemoryAllocator::allocateFromBlock( MemoryBlock& block, VkMemoryRequirements& requirements, Allocation& allocation )
+{
+	//best fit keeps the large ranges intact for large resources
+	auto best = block.freeRanges.end();
+	VkDeviceSize bestOffset = 0;
+	VkDeviceSize bestWaste = numeric_limits<VkDeviceSize>::max();
+
+	for (auto range = block.freeRanges.begin(); range != block.freeRanges.end(); range++)
+	{
+		VkDeviceSize alignedOffset = Util::alignUp( range->first, requirements.alignment );
+		VkDeviceSize rangeEnd = range->first + range->second;
+
+		if (alignedOffset + requirements.size > rangeEnd)
+		{
+			continue;
+		}
+
+		VkDeviceSize waste = range->second - requirements.size;
+		if (waste < bestWaste)
+		{
+			best = range;
+			bestOffset = alignedOffset;
+			bestWaste = waste;
+		}
+	}
+
+	if (best == block.freeRanges.end())
+	{
+		return false;
+	}
+
+	VkDeviceSize rangeOffset = best->first;
+	VkDeviceSize rangeEnd = best->first + best->second;
+	VkDeviceSize allocationEnd = bestOffset + requirements.size;
+
+	block.freeRanges.erase( best );
+
+	if (bestOffset > rangeOffset)
+	{
+		block.freeRanges[rangeOffset] = bestOffset - rangeOffset;
+	}
+	if (allocationEnd < rangeEnd)
+	{
+		block.freeRanges[allocationEnd] = rangeEnd - allocationEnd;
+	}
+
+	allocation.memory = block.memory;
+	allocation.offset = bestOffset;
+	allocation.size = requirements.size;
+	allocation.mapped = block.mapped ? static_cast<char*>(block.mapped) + bestOffset : nullptr;
+	allocation.memoryType = block.memoryType;
+	allocation.properties = memProps.memoryTypes[block.memoryType].propertyFlags;
+	allocation.block = &block;
+
+	block.allocationCount++;
+	stats.allocationCount++;
+	stats.usedBytes += requirements.size;
+
+	return true;
+}
+
+MemoryBlock * MemoryAllocator::createBlock( uint32_t memoryType, ResourceKind kind )
+{
+	unique_ptr<MemoryBlock> block = make_unique<MemoryBlock>();
+	block->size = getBlockSize( memoryType );
+	block->mapped = nullptr;
+	block->memoryType = memoryType;
+	block->kind = kind;
+	block->freeRanges[0] = block->size;
+
+	VkMemoryAllocateInfo allocInfo = {};
+	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocInfo.allocationSize = block->size;
+	allocInfo.memoryTypeIndex = memoryType;
+
+	if (vkAllocateMemory( device, &allocInfo, nullptr, &block->memory ) != VK_SUCCESS)
+	{
+		throw runtime_error( "could not allocate gpu memory block" );
+	}
+
+	//host visible blocks stay mapped for their whole lifetime, mapping is not free on every driver
+	if (memProps.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+	{
+		vkMapMemory( device, block->memory, 0, VK_WHOLE_SIZE, 0, &block->mapped );
+	}
+
+	stats.blockCount++;
+	stats.reservedBytes += block->size;
+	stats.lifetimeDeviceAllocations++;
+
+	MemoryBlock * result = block.get();
+	pools[{ memoryType, kind }].push_back( move( block ) );
+
+	return result;
+}
+
+void MemoryAllocator::destroyBlock( MemoryBlock * block )
+{
+	auto& blocks = pools[{ block->memoryType, block->kind }];
+
+	if (block->mapped)
+	{
+		vkUnmapMemory( device, block->memory );
+	}
+	vkFreeMemory( device, block->memory, nullptr );
+
+	stats.blockCount--;
+	stats.reservedBytes -= block->size;
+
+	blocks.erase( remove_if( blocks.begin(), blocks.end(), [block]( unique_ptr<MemoryBlock>& b ) { return b.get() == block; } ), blocks.end() );
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+
+using namespace std;
+
+namespace com::gelunox::vulcanUtils
+{
+	struct MemoryBlock;
+
+	//a range inside a (usually shared) VkDeviceMemory, bind resources with memory + offset
+	struct Allocation
+	{
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		VkDeviceSize offset = 0;
+		VkDeviceSize size = 0;
+		//persistently mapped pointer to offset, null when the memory isn't host visible
+		void * mapped = nullptr;
+
+		uint32_t memoryType = 0;
+		VkMemoryPropertyFlags properties = 0;
+
+		//null for dedicated allocations
+		MemoryBlock * block = nullptr;
+	};
+
+	struct AllocatorStats
+	{
+		uint32_t blockCount = 0;
+		uint32_t dedicatedCount = 0;
+		uint32_t allocationCount = 0;
+		VkDeviceSize reservedBytes = 0;
+		VkDeviceSize usedBytes = 0;
+		uint64_t lifetimeAllocations = 0;
+		uint64_t lifetimeDeviceAllocations = 0;
+	};
+
+	//buffers and linear images never share a block with optimal images so bufferImageGranularity can't be violated
+	enum class ResourceKind
+	{
+		LINEAR,
+		OPTIMAL
+	};
+
+	struct MemoryBlock
+	{
+		VkDeviceMemory memory;
+		VkDeviceSize size;
+		void * mapped;
+
+		uint32_t memoryType;
+		ResourceKind kind;
+
+		//offset -> size, kept coalesced
+		map<VkDeviceSize, VkDeviceSize> freeRanges;
+		uint32_t allocationCount = 0;
+	};
+
+	//sub-allocates resources from a few large vkAllocateMemory blocks per memory type
+	//instead of one driver allocation per resource, which runs into maxMemoryAllocationCount
+	class MemoryAllocator
+	{
+	private:
+		VkPhysicalDevice physicalDevice;
+		VkDevice device;
+
+		VkPhysicalDeviceMemoryProperties memProps;
+		VkDeviceSize preferredBlockSize;
+
+		//one list of blocks per memory type and resource kind
+		map<pair<uint32_t, ResourceKind>, vector<unique_ptr<MemoryBlock>>> pools;
+		AllocatorStats stats;
+
+		mutex lock;
+
+	public:
+		MemoryAllocator( VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize preferredBlockSize = 64ull * 1024 * 1024 );
+		~MemoryAllocator();
+
+		Allocation allocate( VkMemoryRequirements requirements, VkMemoryPropertyFlags properties, ResourceKind kind );
+		void free( Allocation& allocation );
+
+		Allocation allocateForBuffer( VkBuffer buffer, VkMemoryPropertyFlags properties );
+		Allocation allocateForImage( VkImage image, VkMemoryPropertyFlags properties );
+
+		AllocatorStats getStats();
+		void report( ostream& out );
+
+	private:
+		VkDeviceSize getBlockSize( uint32_t memoryType );
+		Allocation allocateDedicated( VkMemoryRequirements& requirements, uint32_t memoryType );
+		bool allocateFromBlock( MemoryBlock& block, VkMemoryRequirements& requirements, Allocation& allocation );
+		MemoryBlock * createBlock( uint32_t memoryType, ResourceKind kind );
+		void destroyBlock( MemoryBlock * block );
+	};
+}
@@ -0,0 +1,172 @@
+#include "StagingRing.hpp"
+
+#include "../util/Util.hpp"
+
+#include <stdexcept>
+#include <limits>
+
+using namespace com::gelunox::vulcanUtils;
+using namespace std;
+
+StagingRing::StagingRing( VkDevice device, MemoryAllocator * allocator, VkDeviceSize capacity )
+	: device( device ), allocator( allocator ), capacity( capacity )
+{
+	VkBufferCreateInfo bufferInfo = {};
+	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size = capacity;
+	bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	if (vkCreateBuffer( device, &bufferInfo, nullptr, &buffer ) != VK_SUCCESS)
+	{
+		throw runtime_error( "Error creating staging buffer" );
+	}
+
+	//coherent so no flushes are needed after writing a region
+	memory = allocator->allocateForBuffer( buffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT );
+}
+
+StagingRing::~StagingRing()
+{
+	while (!inFlight.empty())
+	{
+		retireOldest( true );
+	}
+
+	for (VkFence fence : freeFences)
+	{
+		vkDestroyFence( device, fence, nullptr );
+	}
+
+	vkDestroyBuffer( device, buffer, nullptr );
+	allocator->free( memory );
+}
+
+StagingRegion StagingRing::reserve( VkDeviceSize size, VkDeviceSize alignment )
+{
+	StagingRegion region;
+
+	if (!tryReserve( size, alignment, region ))
+	{
+		throw runtime_error( "staging ring is full of uncommitted uploads, commit them first" );
+	}
+
+	return region;
+}
+
+bool StagingRing::tryReserve( VkDeviceSize size, VkDeviceSize alignment, StagingRegion& region )
+{
+	if (size > capacity)
+	{
+		throw invalid_argument( "staging reservation is larger than the ring, split the upload" );
+	}
+
+	reclaim();
+
+	if (used == 0)
+	{
+		head = 0;
+	}
+
+	VkDeviceSize offset = Util::alignUp( head, alignment );
+	VkDeviceSize needed;
+
+	if (offset + size > capacity)
+	{
+		//doesn't fit before the end, skip the remainder and start over at the front
+		offset = 0;
+		needed = capacity - head + size;
+	}
+	else
+	{
+		needed = offset - head + size;
+	}
+
+	while (used + needed > capacity)
+	{
+		if (inFlight.empty())
+		{
+			return false;
+		}
+
+		retireOldest( true );
+	}
+
+	head = offset + size;
+	used += needed;
+	pending += needed;
+
+	region.buffer = buffer;
+	region.offset = offset;
+	region.size = size;
+	region.mapped = static_cast<char*>(memory.mapped) + offset;
+
+	return true;
+}
+
+VkFence StagingRing::commit( uint64_t& serial )
+{
+	VkFence fence;
+
+	if (freeFences.empty())
+	{
+		VkFenceCreateInfo fenceInfo = {};
+		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+		if (vkCreateFence( device, &fenceInfo, nullptr, &fence ) != VK_SUCCESS)
+		{
+			throw runtime_error( "fence creation failed" );
+		}
+	}
+	else
+	{
+		fence = freeFences.back();
+		freeFences.pop_back();
+	}
+
+	serial = nextSerial++;
+	inFlight.push_back( { fence, pending, serial } );
+	pending = 0;
+
+	return fence;
+}
+
+void StagingRing::reclaim()
+{
+	while (!inFlight.empty() && vkGetFenceStatus( device, inFlight.front().fence ) == VK_SUCCESS)
+	{
+		retireOldest( false );
+	}
+}
+
+bool StagingRing::isComplete( uint64_t serial )
+{
+	reclaim();
+
+	return serial <= completedSerial;
+}
+
+void StagingRing::wait( uint64_t serial )
+{
+	while (completedSerial < serial && !inFlight.empty())
+	{
+		retireOldest( true );
+	}
+}
+
+void StagingRing::retireOldest( bool wait )
+{
+	Submission& oldest = inFlight.front();
+
+	if (wait)
+	{
+		vkWaitForFences( device, 1, &oldest.fence, VK_TRUE, numeric_limits<uint64_t>::max() );
+	}
+
+	vkResetFences( device, 1, &oldest.fence );
+	freeFences.push_back( oldest.fence );
+	used -= oldest.size;
+	completedSerial = oldest.serial;
+
+	inFlight.pop_front();
+}
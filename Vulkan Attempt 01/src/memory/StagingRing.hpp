@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <deque>
+#include <vector>
+
+#include "MemoryAllocator.hpp"
+
+using namespace std;
+
+namespace com::gelunox::vulcanUtils
+{
+	//a piece of the ring the cpu may write to until the next commit
+	struct StagingRegion
+	{
+		VkBuffer buffer;
+		VkDeviceSize offset;
+		VkDeviceSize size;
+		void * mapped;
+	};
+
+	//one persistently mapped staging buffer shared by every upload
+	//reserved bytes belong to the fence returned by the next commit() and are reused once that fence signals
+	//commits are numbered, so a serial can be waited on long after its fence was recycled
+	class StagingRing
+	{
+	private:
+		struct Submission
+		{
+			VkFence fence;
+			VkDeviceSize size;
+			uint64_t serial;
+		};
+
+		VkDevice device;
+		MemoryAllocator * allocator;
+
+		VkBuffer buffer;
+		Allocation memory;
+		VkDeviceSize capacity;
+
+		//next free byte, bytes between the oldest submission and head (wrap padding included)
+		VkDeviceSize head = 0;
+		VkDeviceSize used = 0;
+		//bytes reserved since the last commit
+		VkDeviceSize pending = 0;
+
+		deque<Submission> inFlight;
+		vector<VkFence> freeFences;
+
+		uint64_t nextSerial = 1;
+		uint64_t completedSerial = 0;
+
+	public:
+		StagingRing( VkDevice device, MemoryAllocator * allocator, VkDeviceSize capacity = 16ull * 1024 * 1024 );
+		~StagingRing();
+
+		//blocks on old submissions when the ring is full, size can't exceed the capacity
+		StagingRegion reserve( VkDeviceSize size, VkDeviceSize alignment = 16 );
+		//same as reserve, but returns false instead of throwing when only uncommitted regions are in the way
+		bool tryReserve( VkDeviceSize size, VkDeviceSize alignment, StagingRegion & region );
+		//fence the caller has to submit the copies reading the reserved regions with
+		VkFence commit( uint64_t & serial );
+
+		//recycles the space of every submission that finished
+		void reclaim();
+		bool isComplete( uint64_t serial );
+		void wait( uint64_t serial );
+
+		VkDeviceSize getCapacity() { return capacity; }
+
+	private:
+		void retireOldest( bool wait );
+	};
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <vector>
+
+#include "../Vertex.hpp"
+#include "../DrawQueue.hpp"
+
+using namespace std;
+
+namespace com::gelunox::vulcanUtils
+{
+	//geometry of one or more meshes in a shared vertex and index array
+	//a mesh's vertices are contiguous from its vertexOffset and its indices are relative to it
+	struct MeshData
+	{
+		vector<Vertex> vertices;
+		vector<uint32_t> indices;
+		vector<Mesh> meshes;
+		//parallel to meshes
+		vector<uint32_t> vertexCounts;
+	};
+}
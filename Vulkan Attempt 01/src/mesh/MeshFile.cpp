@@ -0,0 +1,173 @@
+#include "MeshFile.hpp"
+
+#include <fstream>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+
+using namespace com::gelunox::vulcanUtils;
+using namespace std;
+
+static const char MESH_MAGIC[8] = { 'G', 'L', 'X', 'M', 'E', 'S', 'H', 0 };
+static const uint32_t MESH_VERSION = 2;
+
+//colors and texture coordinates in 0..1 only ever round by less than this, anything more was clamped
+static const float ATTRIBUTE_TOLERANCE = 1.0f / 256.0f;
+
+static uint64_t alignTo16( uint64_t offset )
+{
+	return (offset + 15) & ~uint64_t( 15 );
+}
+
+//PackedVertex holds less than Vertex, a mesh it would clamp or round out of shape is refused instead of written
+static void checkPacking( const MeshData& mesh, const string& path )
+{
+	for (size_t i = 0; i < mesh.meshes.size(); i++)
+	{
+		const Mesh& source = mesh.meshes[i];
+		//half floats keep about three digits of the distance to the origin, the mesh's own size is what has to survive
+		float positionTolerance = source.sphere.w / 256.0f;
+
+		for (uint32_t v = 0; v < mesh.vertexCounts[i]; v++)
+		{
+			vec3 errors = PackedVertex::getErrors( mesh.vertices[source.vertexOffset + v] );
+
+			//written so NaN fails as well
+			if (!(errors.x <= positionTolerance))
+			{
+				throw runtime_error( "mesh positions are too large or too far from the origin for half floats, cook it centred on its origin: " + path );
+			}
+			if (!(errors.y <= ATTRIBUTE_TOLERANCE))
+			{
+				throw runtime_error( "mesh colors outside 0..1 can't be stored: " + path );
+			}
+			if (!(errors.z <= ATTRIBUTE_TOLERANCE))
+			{
+				throw runtime_error( "mesh texture coordinates outside 0..1 can't be stored, repeating textures aren't supported: " + path );
+			}
+		}
+	}
+}
+
+MeshFile::MeshFile( AssetData file, const string& name ) : data( move( file ) )
+{
+	if (data.size() < sizeof( MeshFileHeader ))
+	{
+		throw runtime_error( "not a mesh: " + name );
+	}
+	memcpy( &header, data.data(), sizeof( header ) );
+
+	if (memcmp( header.magic, MESH_MAGIC, sizeof( MESH_MAGIC ) ) != 0 || header.version != MESH_VERSION)
+	{
+		throw runtime_error( "not a mesh, or one of another version: " + name );
+	}
+	if (header.vertexStride != sizeof( PackedVertex ) || header.vertexLayout != PackedVertex::getLayoutId())
+	{
+		throw runtime_error( "mesh was cooked with another vertex layout, cook it again: " + name );
+	}
+
+	uint64_t entriesEnd = sizeof( MeshFileHeader ) + uint64_t( header.meshCount ) * sizeof( MeshFileEntry );
+	uint64_t verticesEnd = header.vertexOffset + uint64_t( header.vertexCount ) * header.vertexStride;
+	uint64_t indicesEnd = header.indexOffset + uint64_t( header.indexCount ) * sizeof( uint32_t );
+
+	if (entriesEnd > data.size() || header.vertexOffset < entriesEnd || verticesEnd > data.size() || indicesEnd > data.size()
+		|| header.vertexOffset % 16 != 0 || header.indexOffset % 4 != 0)
+	{
+		throw runtime_error( "mesh is truncated: " + name );
+	}
+
+	meshes.resize( header.meshCount );
+	vertexCounts.resize( header.meshCount );
+
+	for (uint32_t i = 0; i < header.meshCount; i++)
+	{
+		MeshFileEntry entry;
+		memcpy( &entry, data.data() + sizeof( MeshFileHeader ) + i * sizeof( MeshFileEntry ), sizeof( entry ) );
+
+		if (uint64_t( entry.firstIndex ) + entry.indexCount > header.indexCount
+			|| entry.vertexOffset < 0 || uint64_t( entry.vertexOffset ) + entry.vertexCount > header.vertexCount)
+		{
+			throw runtime_error( "mesh entry points outside of the mesh: " + name );
+		}
+
+		//checked once here so the draws, and GeometryArena narrowing them to 16 bits, can trust every index
+		for (uint32_t j = 0; j < entry.indexCount; j++)
+		{
+			uint32_t index;
+			memcpy( &index, data.data() + header.indexOffset + (uint64_t( entry.firstIndex ) + j) * sizeof( uint32_t ), sizeof( index ) );
+
+			if (index >= entry.vertexCount)
+			{
+				throw runtime_error( "mesh is truncated, an index points past its mesh's vertices: " + name );
+			}
+		}
+
+		meshes[i] = { entry.indexCount, entry.firstIndex, entry.vertexOffset,
+			vec4( entry.sphere[0], entry.sphere[1], entry.sphere[2], entry.sphere[3] ) };
+		vertexCounts[i] = entry.vertexCount;
+	}
+}
+
+uint32_t MeshFile::getMaxMeshVertexCount() const
+{
+	uint32_t maxCount = 0;
+	for (uint32_t count : vertexCounts)
+	{
+		maxCount = max( maxCount, count );
+	}
+
+	return maxCount;
+}
+
+void MeshFile::write( const MeshData& mesh, const string& path )
+{
+	checkPacking( mesh, path );
+
+	MeshFileHeader header = {};
+	memcpy( header.magic, MESH_MAGIC, sizeof( MESH_MAGIC ) );
+	header.version = MESH_VERSION;
+	header.vertexStride = sizeof( PackedVertex );
+	header.meshCount = static_cast<uint32_t>(mesh.meshes.size());
+	header.vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+	header.indexCount = static_cast<uint32_t>(mesh.indices.size());
+	header.vertexLayout = PackedVertex::getLayoutId();
+	header.vertexOffset = alignTo16( sizeof( MeshFileHeader ) + mesh.meshes.size() * sizeof( MeshFileEntry ) );
+	header.indexOffset = header.vertexOffset + mesh.vertices.size() * sizeof( PackedVertex );
+
+	vector<char> bytes( header.indexOffset + mesh.indices.size() * sizeof( uint32_t ), 0 );
+	memcpy( bytes.data(), &header, sizeof( header ) );
+
+	for (size_t i = 0; i < mesh.meshes.size(); i++)
+	{
+		const Mesh& source = mesh.meshes[i];
+
+		MeshFileEntry entry = {};
+		entry.indexCount = source.indexCount;
+		entry.firstIndex = source.firstIndex;
+		entry.vertexOffset = source.vertexOffset;
+		entry.vertexCount = mesh.vertexCounts[i];
+		entry.sphere[0] = source.sphere.x;
+		entry.sphere[1] = source.sphere.y;
+		entry.sphere[2] = source.sphere.z;
+		entry.sphere[3] = source.sphere.w;
+
+		memcpy( bytes.data() + sizeof( MeshFileHeader ) + i * sizeof( MeshFileEntry ), &entry, sizeof( entry ) );
+	}
+
+	vector<PackedVertex> packed;
+	packed.reserve( mesh.vertices.size() );
+	for (const Vertex& vertex : mesh.vertices)
+	{
+		packed.push_back( PackedVertex::pack( vertex ) );
+	}
+
+	memcpy( bytes.data() + header.vertexOffset, packed.data(), packed.size() * sizeof( PackedVertex ) );
+	memcpy( bytes.data() + header.indexOffset, mesh.indices.data(), mesh.indices.size() * sizeof( uint32_t ) );
+
+	ofstream out( path, ios::binary | ios::trunc );
+	if (!out)
+	{
+		throw runtime_error( "can't write mesh " + path );
+	}
+	out.write( bytes.data(), bytes.size() );
+}
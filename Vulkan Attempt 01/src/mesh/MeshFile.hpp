@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "MeshData.hpp"
+#include "../asset/AssetData.hpp"
+
+using namespace std;
+
+namespace com::gelunox::vulcanUtils
+{
+	//layout of a cooked mesh, all little endian:
+	//MeshFileHeader, a MeshFileEntry per mesh, padding to 16 bytes, the vertices as PackedVertex, the indices as uint32
+	struct MeshFileHeader
+	{
+		char magic[8];
+		uint32_t version;
+		//stride and layout id of PackedVertex when it was cooked, a file of another layout is refused
+		uint32_t vertexStride;
+		uint32_t meshCount;
+		uint32_t vertexCount;
+		uint32_t indexCount;
+		uint32_t vertexLayout;
+		uint64_t vertexOffset;
+		uint64_t indexOffset;
+	};
+
+	struct MeshFileEntry
+	{
+		uint32_t indexCount;
+		uint32_t firstIndex;
+		int32_t vertexOffset;
+		uint32_t vertexCount;
+		float sphere[4];
+	};
+
+	//meshes cooked by MeshImporter and MeshOptimizer, ready to be copied into vertex and index buffers as they are
+	//the vertices are quantised to PackedVertex when written, the bounding spheres still come from the full precision ones
+	//vertices and indices point into the file, a file that is a view into an AssetPack is never copied
+	class MeshFile
+	{
+	private:
+		AssetData data;
+		MeshFileHeader header;
+
+	public:
+		vector<Mesh> meshes;
+		//parallel to meshes
+		vector<uint32_t> vertexCounts;
+
+		//name is only used in errors, throws when the file isn't a mesh or was cooked with another vertex layout
+		MeshFile( AssetData file, const string& name );
+
+		const PackedVertex * getVertices() const { return reinterpret_cast<const PackedVertex *>(data.data() + header.vertexOffset); }
+		const uint32_t * getIndices() const { return reinterpret_cast<const uint32_t *>(data.data() + header.indexOffset); }
+		uint32_t getVertexCount() const { return header.vertexCount; }
+		uint32_t getIndexCount() const { return header.indexCount; }
+		uint32_t getMaxMeshVertexCount() const;
+
+		static void write( const MeshData& mesh, const string& path );
+	};
+}
@@ -0,0 +1,515 @@
+#include "MeshImporter.hpp"
+
+#include <stdexcept>
+#include <algorithm>
+#include <unordered_map>
+#include <sstream>
+#include <fstream>
+#include <cstring>
+#include <cmath>
+
+#include "../util/Util.hpp"
+
+using namespace com::gelunox::vulcanUtils;
+using namespace std;
+
+static const uint32_t GLB_MAGIC = 0x46546C67; //"glTF"
+static const uint32_t GLB_CHUNK_JSON = 0x4E4F534A;
+static const uint32_t GLB_CHUNK_BIN = 0x004E4942;
+
+//Vertex is tightly packed floats, its bytes are its identity
+struct VertexHash
+{
+	size_t operator()( const Vertex& vertex ) const
+	{
+		const uint8_t * bytes = reinterpret_cast<const uint8_t *>(&vertex);
+		uint64_t hash = 14695981039346656037ull;
+
+		for (size_t i = 0; i < sizeof( Vertex ); i++)
+		{
+			hash = (hash ^ bytes[i]) * 1099511628211ull;
+		}
+		return static_cast<size_t>(hash);
+	}
+};
+
+struct VertexEqual
+{
+	bool operator()( const Vertex& a, const Vertex& b ) const
+	{
+		return memcmp( &a, &b, sizeof( Vertex ) ) == 0;
+	}
+};
+
+static string getExtension( const string& path )
+{
+	string extension = path.substr( path.find_last_of( '.' ) + 1 );
+	transform( extension.begin(), extension.end(), extension.begin(), ::tolower );
+
+	return extension;
+}
+
+static string getDirectory( const string& path )
+{
+	size_t slash = path.find_last_of( "/\\" );
+	return slash == string::npos ? "" : path.substr( 0, slash + 1 );
+}
+
+static vector<char> decodeBase64( const string& text )
+{
+	vector<char> bytes;
+	uint32_t bits = 0;
+	int bitCount = 0;
+
+	for (char c : text)
+	{
+		int value;
+		if (c >= 'A' && c <= 'Z') value = c - 'A';
+		else if (c >= 'a' && c <= 'z') value = c - 'a' + 26;
+		else if (c >= '0' && c <= '9') value = c - '0' + 52;
+		else if (c == '+') value = 62;
+		else if (c == '/') value = 63;
+		else if (c == '=') break;
+		else continue;
+
+		bits = bits << 6 | value;
+		bitCount += 6;
+
+		if (bitCount >= 8)
+		{
+			bitCount -= 8;
+			bytes.push_back( static_cast<char>(bits >> bitCount & 0xFF) );
+		}
+	}
+
+	return bytes;
+}
+
+MeshData MeshImporter::import( const string& path )
+{
+	string extension = getExtension( path );
+
+	if (extension == "obj")
+	{
+		return importObj( path );
+	}
+	if (extension == "gltf" || extension == "glb")
+	{
+		return importGltf( path );
+	}
+
+	throw runtime_error( "no importer for " + path );
+}
+
+MeshData MeshImporter::importObj( const string& path )
+{
+	ifstream file( path );
+
+	if (!file.is_open())
+	{
+		throw runtime_error( "can't open file " + path );
+	}
+
+	vector<vec3> positions;
+	vector<vec3> colors;
+	vector<vec2> texCoords;
+
+	MeshData data;
+	vector<Vertex> corners;
+
+	//1 based, negative counts back from the latest element
+	auto resolve = []( long index, size_t count )
+	{
+		long resolved = index < 0 ? static_cast<long>(count) + index : index - 1;
+
+		if (resolved < 0 || resolved >= static_cast<long>(count))
+		{
+			throw runtime_error( "obj face refers to a missing element" );
+		}
+		return static_cast<size_t>(resolved);
+	};
+
+	string line;
+	while (getline( file, line ))
+	{
+		istringstream in( line );
+		string keyword;
+		in >> keyword;
+
+		if (keyword == "v")
+		{
+			vec3 position;
+			vec3 color( 1.0f );
+			in >> position.x >> position.y >> position.z;
+
+			if (!(in >> color.x >> color.y >> color.z))
+			{
+				color = vec3( 1.0f );
+			}
+
+			positions.push_back( position );
+			colors.push_back( color );
+		}
+		else if (keyword == "vt")
+		{
+			vec2 texCoord;
+			in >> texCoord.x >> texCoord.y;
+
+			//obj has v going up, vulkan samples with v going down
+			texCoords.push_back( vec2( texCoord.x, 1.0f - texCoord.y ) );
+		}
+		else if (keyword == "f")
+		{
+			vector<Vertex> polygon;
+			string corner;
+
+			while (in >> corner)
+			{
+				Vertex vertex = {};
+				size_t position = resolve( stol( corner ), positions.size() );
+				vertex.position = positions[position];
+				vertex.color = colors[position];
+
+				size_t slash = corner.find( '/' );
+				if (slash != string::npos && slash + 1 < corner.size() && corner[slash + 1] != '/')
+				{
+					vertex.texCoord = texCoords[resolve( stol( corner.substr( slash + 1 ) ), texCoords.size() )];
+				}
+
+				polygon.push_back( vertex );
+			}
+
+			//a fan keeps the winding of a convex polygon
+			for (size_t i = 2; i < polygon.size(); i++)
+			{
+				corners.push_back( polygon[0] );
+				corners.push_back( polygon[i - 1] );
+				corners.push_back( polygon[i] );
+			}
+		}
+		else if ((keyword == "o" || keyword == "g") && !corners.empty())
+		{
+			addMesh( data, corners );
+			corners.clear();
+		}
+	}
+
+	if (!corners.empty())
+	{
+		addMesh( data, corners );
+	}
+
+	return data;
+}
+
+//https://registry.khronos.org/glTF/specs/2.0/glTF-2.0.html
+MeshData MeshImporter::importGltf( const string& path )
+{
+	vector<char> file = Util::readFile( path );
+	vector<vector<char>> buffers;
+	JsonValue gltf;
+	vector<char> binaryChunk;
+
+	uint32_t magic = 0;
+	if (file.size() >= 4)
+	{
+		memcpy( &magic, file.data(), 4 );
+	}
+
+	if (magic == GLB_MAGIC)
+	{
+		//12 byte header, then chunks of length, type and data
+		size_t offset = 12;
+
+		while (offset + 8 <= file.size())
+		{
+			uint32_t chunkLength;
+			uint32_t chunkType;
+			memcpy( &chunkLength, file.data() + offset, 4 );
+			memcpy( &chunkType, file.data() + offset + 4, 4 );
+			offset += 8;
+
+			if (chunkLength > file.size() - offset)
+			{
+				throw runtime_error( "glb chunk is truncated: " + path );
+			}
+
+			if (chunkType == GLB_CHUNK_JSON)
+			{
+				gltf = JsonValue::parse( file.data() + offset, chunkLength );
+			}
+			else if (chunkType == GLB_CHUNK_BIN && binaryChunk.empty())
+			{
+				binaryChunk.assign( file.begin() + offset, file.begin() + offset + chunkLength );
+			}
+
+			offset += chunkLength;
+		}
+	}
+	else
+	{
+		gltf = JsonValue::parse( file.data(), file.size() );
+	}
+
+	const JsonValue& bufferList = gltf["buffers"];
+	for (size_t i = 0; i < bufferList.size(); i++)
+	{
+		const string& uri = bufferList[i]["uri"].asString();
+		const string base64Marker = ";base64,";
+
+		if (uri.empty())
+		{
+			//only the first buffer of a glb may leave out its uri
+			buffers.push_back( i == 0 ? move( binaryChunk ) : vector<char>() );
+		}
+		else if (uri.compare( 0, 5, "data:" ) == 0 && uri.find( base64Marker ) != string::npos)
+		{
+			buffers.push_back( decodeBase64( uri.substr( uri.find( base64Marker ) + base64Marker.size() ) ) );
+		}
+		else
+		{
+			buffers.push_back( Util::readFile( getDirectory( path ) + uri ) );
+		}
+	}
+
+	MeshData data;
+	const JsonValue& meshes = gltf["meshes"];
+
+	for (size_t m = 0; m < meshes.size(); m++)
+	{
+		const JsonValue& primitives = meshes[m]["primitives"];
+
+		for (size_t p = 0; p < primitives.size(); p++)
+		{
+			const JsonValue& primitive = primitives[p];
+			const JsonValue& attributes = primitive["attributes"];
+
+			if (primitive["mode"].asUint( 4 ) != 4)
+			{
+				throw runtime_error( "only triangle list primitives can be imported: " + path );
+			}
+			if (!attributes.has( "POSITION" ))
+			{
+				throw runtime_error( "primitive without positions: " + path );
+			}
+
+			uint32_t positionComponents;
+			vector<double> positions = readAccessor( gltf, buffers, attributes["POSITION"].asUint(), positionComponents );
+			size_t vertexCount = positions.size() / positionComponents;
+
+			uint32_t colorComponents = 0;
+			vector<double> colors;
+			if (attributes.has( "COLOR_0" ))
+			{
+				colors = readAccessor( gltf, buffers, attributes["COLOR_0"].asUint(), colorComponents );
+			}
+
+			uint32_t texCoordComponents = 0;
+			vector<double> texCoords;
+			if (attributes.has( "TEXCOORD_0" ))
+			{
+				texCoords = readAccessor( gltf, buffers, attributes["TEXCOORD_0"].asUint(), texCoordComponents );
+			}
+
+			//the spec fixes these, anything else would read past the accessors
+			if (positionComponents != 3 || (!colors.empty() && colorComponents < 3) || (!texCoords.empty() && texCoordComponents != 2)
+				|| (!colors.empty() && colors.size() / colorComponents < vertexCount) || (!texCoords.empty() && texCoords.size() / 2 < vertexCount))
+			{
+				throw runtime_error( "glTF vertex attributes don't match: " + path );
+			}
+
+			vector<uint32_t> indices;
+			if (primitive.has( "indices" ))
+			{
+				uint32_t indexComponents;
+				vector<double> values = readAccessor( gltf, buffers, primitive["indices"].asUint(), indexComponents );
+
+				if (indexComponents != 1)
+				{
+					throw runtime_error( "glTF indices have to be a SCALAR accessor: " + path );
+				}
+				indices.assign( values.begin(), values.end() );
+			}
+			else
+			{
+				for (uint32_t i = 0; i < vertexCount; i++)
+				{
+					indices.push_back( i );
+				}
+			}
+
+			vector<Vertex> corners;
+			corners.reserve( indices.size() );
+
+			for (uint32_t index : indices)
+			{
+				if (index >= vertexCount)
+				{
+					throw runtime_error( "glTF index refers to a missing vertex: " + path );
+				}
+
+				Vertex vertex = {};
+				vertex.position = vec3( static_cast<float>(positions[index * positionComponents]),
+					static_cast<float>(positions[index * positionComponents + 1]),
+					static_cast<float>(positions[index * positionComponents + 2]) );
+				vertex.color = colors.empty() ? vec3( 1.0f ) : vec3( static_cast<float>(colors[index * colorComponents]),
+					static_cast<float>(colors[index * colorComponents + 1]),
+					static_cast<float>(colors[index * colorComponents + 2]) );
+
+				//glTF already has v going down
+				if (!texCoords.empty())
+				{
+					vertex.texCoord = vec2( static_cast<float>(texCoords[index * texCoordComponents]),
+						static_cast<float>(texCoords[index * texCoordComponents + 1]) );
+				}
+
+				corners.push_back( vertex );
+			}
+
+			corners.resize( corners.size() / 3 * 3 );
+			addMesh( data, corners );
+		}
+	}
+
+	return data;
+}
+
+//every component as a double, normalized integers already mapped to 0..1 or -1..1
+vector<double> MeshImporter::readAccessor( const JsonValue& gltf, const vector<vector<char>>& buffers, uint32_t index, uint32_t& components )
+{
+	const JsonValue& accessor = gltf["accessors"][index];
+
+	if (accessor.isNull() || accessor.has( "sparse" ))
+	{
+		throw runtime_error( "glTF accessor is missing or sparse" );
+	}
+
+	const string& type = accessor["type"].asString();
+	components = type == "SCALAR" ? 1 : type == "VEC2" ? 2 : type == "VEC3" ? 3 : type == "VEC4" ? 4 : 0;
+	if (components == 0)
+	{
+		throw runtime_error( "glTF accessor type " + type + " can't be imported" );
+	}
+
+	uint32_t componentType = accessor["componentType"].asUint();
+	bool normalized = accessor["normalized"].asBool();
+	size_t count = accessor["count"].asUint();
+
+	size_t componentSize;
+	switch (componentType)
+	{
+	case 5120: case 5121: componentSize = 1; break;
+	case 5122: case 5123: componentSize = 2; break;
+	case 5125: case 5126: componentSize = 4; break;
+	default: throw runtime_error( "unknown glTF component type" );
+	}
+
+	//without a buffer view the accessor is all zeros
+	if (!accessor.has( "bufferView" ))
+	{
+		return vector<double>( count * components, 0.0 );
+	}
+
+	const JsonValue& view = gltf["bufferViews"][accessor["bufferView"].asUint()];
+	uint32_t bufferIndex = view["buffer"].asUint();
+
+	if (bufferIndex >= buffers.size())
+	{
+		throw runtime_error( "glTF buffer view refers to a missing buffer" );
+	}
+
+	const vector<char>& buffer = buffers[bufferIndex];
+	size_t elementSize = componentSize * components;
+	size_t stride = view["byteStride"].asUint( static_cast<uint32_t>(elementSize) );
+	double viewOffset = view["byteOffset"].asNumber();
+	double accessorOffset = accessor["byteOffset"].asNumber();
+
+	if (viewOffset < 0.0 || accessorOffset < 0.0 || viewOffset + accessorOffset > buffer.size())
+	{
+		throw runtime_error( "glTF accessor has an offset outside its buffer" );
+	}
+
+	size_t offset = static_cast<size_t>(viewOffset) + static_cast<size_t>(accessorOffset);
+
+	//divided instead of multiplied, a 32 bit count and stride can overflow the product
+	if (count > 0 && (offset + elementSize > buffer.size() || (stride > 0 && count - 1 > (buffer.size() - offset - elementSize) / stride)))
+	{
+		throw runtime_error( "glTF accessor reads past the end of its buffer" );
+	}
+
+	//only allocated once the count is known to fit the buffer, a bogus one could otherwise ask for gigabytes
+	vector<double> values( count * components, 0.0 );
+
+	for (size_t element = 0; element < count; element++)
+	{
+		const char * source = buffer.data() + offset + element * stride;
+
+		for (uint32_t c = 0; c < components; c++)
+		{
+			const char * p = source + c * componentSize;
+			double& value = values[element * components + c];
+
+			switch (componentType)
+			{
+			case 5120: { int8_t v; memcpy( &v, p, 1 ); value = normalized ? max( v / 127.0, -1.0 ) : v; break; }
+			case 5121: { uint8_t v; memcpy( &v, p, 1 ); value = normalized ? v / 255.0 : v; break; }
+			case 5122: { int16_t v; memcpy( &v, p, 2 ); value = normalized ? max( v / 32767.0, -1.0 ) : v; break; }
+			case 5123: { uint16_t v; memcpy( &v, p, 2 ); value = normalized ? v / 65535.0 : v; break; }
+			case 5125: { uint32_t v; memcpy( &v, p, 4 ); value = v; break; }
+			case 5126: { float v; memcpy( &v, p, 4 ); value = v; break; }
+			}
+		}
+	}
+
+	return values;
+}
+
+void MeshImporter::addMesh( MeshData& data, const vector<Vertex>& corners )
+{
+	if (corners.empty())
+	{
+		return;
+	}
+
+	Mesh mesh = {};
+	mesh.firstIndex = static_cast<uint32_t>(data.indices.size());
+	mesh.indexCount = static_cast<uint32_t>(corners.size());
+	mesh.vertexOffset = static_cast<int32_t>(data.vertices.size());
+
+	unordered_map<Vertex, uint32_t, VertexHash, VertexEqual> unique;
+	unique.reserve( corners.size() );
+
+	for (const Vertex& corner : corners)
+	{
+		auto inserted = unique.emplace( corner, static_cast<uint32_t>(unique.size()) );
+
+		if (inserted.second)
+		{
+			data.vertices.push_back( corner );
+		}
+		data.indices.push_back( inserted.first->second );
+	}
+
+	uint32_t vertexCount = static_cast<uint32_t>(unique.size());
+
+	//center of the bounds, close enough to the smallest sphere for culling
+	vec3 low = data.vertices[mesh.vertexOffset].position;
+	vec3 high = low;
+	for (uint32_t i = 0; i < vertexCount; i++)
+	{
+		low = glm::min( low, data.vertices[mesh.vertexOffset + i].position );
+		high = glm::max( high, data.vertices[mesh.vertexOffset + i].position );
+	}
+
+	vec3 center = (low + high) * 0.5f;
+	float radius = 0.0f;
+	for (uint32_t i = 0; i < vertexCount; i++)
+	{
+		radius = std::max( radius, length( data.vertices[mesh.vertexOffset + i].position - center ) );
+	}
+
+	mesh.sphere = vec4( center, radius );
+
+	data.meshes.push_back( mesh );
+	data.vertexCounts.push_back( vertexCount );
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "MeshData.hpp"
+#include "../util/Json.hpp"
+
+using namespace std;
+
+namespace com::gelunox::vulcanUtils
+{
+	//turns OBJ and glTF files into MeshData, offline only, the renderer loads what MeshFile cooked from it
+	//an OBJ object or group and a glTF primitive each become a mesh, vertices are deduplicated per mesh
+	class MeshImporter
+	{
+	public:
+		//picks the format by extension: .obj, .gltf or .glb
+		static MeshData import( const string& path );
+
+	private:
+		//positions may be followed by an rgb color, the common extension of the format
+		static MeshData importObj( const string& path );
+		//triangle primitives only, node transforms are not applied
+		static MeshData importGltf( const string& path );
+
+		static vector<double> readAccessor( const JsonValue& gltf, const vector<vector<char>>& buffers, uint32_t index, uint32_t& components );
+
+		//three corners per triangle, identical corners share a vertex
+		static void addMesh( MeshData& data, const vector<Vertex>& corners );
+	};
+}
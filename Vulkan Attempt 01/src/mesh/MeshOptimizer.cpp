@@ -0,0 +1,332 @@
+#include "MeshOptimizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace com::gelunox::vulcanUtils;
+using namespace std;
+
+static const int CACHE_SIZE = 32;
+static const float LAST_TRIANGLE_SCORE = 0.75f;
+static const float CACHE_DECAY_POWER = 1.5f;
+static const float VALENCE_BOOST_SCALE = 2.0f;
+static const float VALENCE_BOOST_POWER = 0.5f;
+
+//vertices of the last triangle get a fixed score so they don't win twice in a row, the rest decays with their age
+//vertices with few triangles left score higher, finishing them off stops them from lingering as single stragglers
+static float getVertexScore( int cachePosition, uint32_t remainingTriangles )
+{
+	if (remainingTriangles == 0)
+	{
+		return -1.0f;
+	}
+
+	float score = 0.0f;
+
+	if (cachePosition >= 0)
+	{
+		if (cachePosition < 3)
+		{
+			score = LAST_TRIANGLE_SCORE;
+		}
+		else
+		{
+			float scaler = 1.0f / (CACHE_SIZE - 3);
+			score = powf( 1.0f - (cachePosition - 3) * scaler, CACHE_DECAY_POWER );
+		}
+	}
+
+	return score + VALENCE_BOOST_SCALE * powf( static_cast<float>(remainingTriangles), -VALENCE_BOOST_POWER );
+}
+
+void MeshOptimizer::optimize( MeshData& data )
+{
+	for (size_t i = 0; i < data.meshes.size(); i++)
+	{
+		const Mesh& mesh = data.meshes[i];
+		uint32_t * indices = data.indices.data() + mesh.firstIndex;
+		Vertex * vertices = data.vertices.data() + mesh.vertexOffset;
+
+		//overdraw works on the clusters of the cache order, fetch renumbers whatever order the triangles end up in
+		optimizeVertexCache( indices, mesh.indexCount, data.vertexCounts[i] );
+		optimizeOverdraw( indices, mesh.indexCount, vertices, data.vertexCounts[i] );
+		optimizeVertexFetch( vertices, data.vertexCounts[i], indices, mesh.indexCount );
+	}
+}
+
+void MeshOptimizer::optimizeVertexCache( uint32_t * indices, size_t indexCount, uint32_t vertexCount )
+{
+	size_t triangleCount = indexCount / 3;
+
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	//triangles per vertex as one flat list, the first remaining[v] entries of a vertex's range are the ones not yet emitted
+	vector<uint32_t> remaining( vertexCount, 0 );
+	for (size_t i = 0; i < triangleCount * 3; i++)
+	{
+		remaining[indices[i]]++;
+	}
+
+	vector<uint32_t> firstTriangle( vertexCount + 1, 0 );
+	for (uint32_t v = 0; v < vertexCount; v++)
+	{
+		firstTriangle[v + 1] = firstTriangle[v] + remaining[v];
+	}
+
+	vector<uint32_t> triangles( triangleCount * 3 );
+	vector<uint32_t> filled( vertexCount, 0 );
+	for (size_t i = 0; i < triangleCount * 3; i++)
+	{
+		uint32_t v = indices[i];
+		triangles[firstTriangle[v] + filled[v]++] = static_cast<uint32_t>(i / 3);
+	}
+
+	vector<int> cachePosition( vertexCount, -1 );
+	vector<float> vertexScore( vertexCount );
+	for (uint32_t v = 0; v < vertexCount; v++)
+	{
+		vertexScore[v] = getVertexScore( -1, remaining[v] );
+	}
+
+	vector<bool> emitted( triangleCount, false );
+	vector<uint32_t> output( triangleCount * 3 );
+	vector<uint32_t> cache;
+	vector<uint32_t> nextCache;
+	size_t fallback = 0;
+	int64_t best = -1;
+
+	for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++)
+	{
+		//nothing in the cache has triangles left, continue with the next one in input order
+		if (best < 0)
+		{
+			while (emitted[fallback])
+			{
+				fallback++;
+			}
+			best = static_cast<int64_t>(fallback);
+		}
+
+		const uint32_t * triangle = indices + best * 3;
+		emitted[best] = true;
+		copy( triangle, triangle + 3, output.begin() + emittedCount * 3 );
+
+		nextCache.assign( triangle, triangle + 3 );
+
+		for (int corner = 0; corner < 3; corner++)
+		{
+			uint32_t v = triangle[corner];
+			uint32_t * list = triangles.data() + firstTriangle[v];
+
+			//swap it out of the vertex's remaining range
+			uint32_t * found = find( list, list + remaining[v], static_cast<uint32_t>(best) );
+			swap( *found, list[remaining[v] - 1] );
+			remaining[v]--;
+		}
+
+		for (uint32_t v : cache)
+		{
+			if (find( nextCache.begin(), nextCache.end(), v ) == nextCache.end())
+			{
+				nextCache.push_back( v );
+			}
+		}
+
+		//evicted vertices are rescored as well, they lost their cache bonus
+		for (size_t i = 0; i < nextCache.size(); i++)
+		{
+			uint32_t v = nextCache[i];
+			cachePosition[v] = i < CACHE_SIZE ? static_cast<int>(i) : -1;
+			vertexScore[v] = getVertexScore( cachePosition[v], remaining[v] );
+		}
+
+		best = -1;
+		float bestScore = -1.0f;
+
+		for (uint32_t v : nextCache)
+		{
+			for (uint32_t i = 0; i < remaining[v]; i++)
+			{
+				uint32_t t = triangles[firstTriangle[v] + i];
+				float score = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+
+				if (cachePosition[v] >= 0 && score > bestScore)
+				{
+					best = t;
+					bestScore = score;
+				}
+			}
+		}
+
+		if (nextCache.size() > CACHE_SIZE)
+		{
+			nextCache.resize( CACHE_SIZE );
+		}
+		cache.swap( nextCache );
+	}
+
+	copy( output.begin(), output.end(), indices );
+}
+
+void MeshOptimizer::optimizeOverdraw( uint32_t * indices, size_t indexCount, const Vertex * vertices, uint32_t vertexCount )
+{
+	size_t triangleCount = indexCount / 3;
+
+	if (triangleCount < 2)
+	{
+		return;
+	}
+
+	//a triangle that misses on all three vertices starts from a cold cache, reordering there costs nothing
+	const uint32_t cacheSize = 16;
+	vector<uint32_t> clusterStarts;
+	vector<uint32_t> insertedAt( vertexCount, 0 );
+	uint32_t time = cacheSize + 1;
+
+	for (size_t t = 0; t < triangleCount; t++)
+	{
+		int misses = 0;
+
+		for (int corner = 0; corner < 3; corner++)
+		{
+			uint32_t v = indices[t * 3 + corner];
+
+			if (time - insertedAt[v] > cacheSize)
+			{
+				insertedAt[v] = time++;
+				misses++;
+			}
+		}
+
+		if (t == 0 || misses == 3)
+		{
+			clusterStarts.push_back( static_cast<uint32_t>(t) );
+		}
+	}
+
+	if (clusterStarts.size() < 2)
+	{
+		return;
+	}
+
+	vec3 meshCenter( 0.0f );
+	for (uint32_t v = 0; v < vertexCount; v++)
+	{
+		meshCenter = meshCenter + vertices[v].position;
+	}
+	meshCenter = meshCenter / static_cast<float>(vertexCount);
+
+	struct Cluster
+	{
+		uint32_t first;
+		uint32_t count;
+		float sortKey;
+	};
+	vector<Cluster> clusters;
+
+	for (size_t c = 0; c < clusterStarts.size(); c++)
+	{
+		uint32_t first = clusterStarts[c];
+		uint32_t end = c + 1 < clusterStarts.size() ? clusterStarts[c + 1] : static_cast<uint32_t>(triangleCount);
+
+		//area weighted, the cross product's length is twice the area
+		vec3 center( 0.0f );
+		vec3 normal( 0.0f );
+		float area = 0.0f;
+
+		for (uint32_t t = first; t < end; t++)
+		{
+			vec3 a = vertices[indices[t * 3]].position;
+			vec3 b = vertices[indices[t * 3 + 1]].position;
+			vec3 c3 = vertices[indices[t * 3 + 2]].position;
+
+			vec3 faceNormal = cross( b - a, c3 - a );
+			float faceArea = length( faceNormal );
+
+			center = center + (a + b + c3) * (faceArea / 3.0f);
+			normal = normal + faceNormal;
+			area += faceArea;
+		}
+
+		float sortKey = 0.0f;
+		if (area > 0.0f && length( normal ) > 0.0f)
+		{
+			center = center / area;
+			sortKey = dot( center - meshCenter, normalize( normal ) );
+		}
+
+		clusters.push_back( { first, end - first, sortKey } );
+	}
+
+	//facing away from the center first, those are the ones that cover the rest
+	stable_sort( clusters.begin(), clusters.end(), []( const Cluster& a, const Cluster& b ) { return a.sortKey > b.sortKey; } );
+
+	vector<uint32_t> sorted;
+	sorted.reserve( triangleCount * 3 );
+
+	for (const Cluster& cluster : clusters)
+	{
+		sorted.insert( sorted.end(), indices + cluster.first * 3, indices + (cluster.first + cluster.count) * 3 );
+	}
+
+	copy( sorted.begin(), sorted.end(), indices );
+}
+
+void MeshOptimizer::optimizeVertexFetch( Vertex * vertices, uint32_t vertexCount, uint32_t * indices, size_t indexCount )
+{
+	const uint32_t unused = ~0u;
+	vector<uint32_t> remap( vertexCount, unused );
+	vector<Vertex> reordered;
+	reordered.reserve( vertexCount );
+
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		uint32_t& target = remap[indices[i]];
+
+		if (target == unused)
+		{
+			target = static_cast<uint32_t>(reordered.size());
+			reordered.push_back( vertices[indices[i]] );
+		}
+		indices[i] = target;
+	}
+
+	//vertices no triangle uses keep their place at the end, the vertex count doesn't change
+	for (uint32_t v = 0; v < vertexCount; v++)
+	{
+		if (remap[v] == unused)
+		{
+			reordered.push_back( vertices[v] );
+		}
+	}
+
+	copy( reordered.begin(), reordered.end(), vertices );
+}
+
+float MeshOptimizer::getAverageCacheMissRatio( const uint32_t * indices, size_t indexCount, uint32_t vertexCount, uint32_t cacheSize )
+{
+	size_t triangleCount = indexCount / 3;
+
+	if (triangleCount == 0)
+	{
+		return 0.0f;
+	}
+
+	vector<uint32_t> insertedAt( vertexCount, 0 );
+	uint32_t time = cacheSize + 1;
+	size_t misses = 0;
+
+	for (size_t i = 0; i < triangleCount * 3; i++)
+	{
+		if (time - insertedAt[indices[i]] > cacheSize)
+		{
+			insertedAt[indices[i]] = time++;
+			misses++;
+		}
+	}
+
+	return static_cast<float>(misses) / triangleCount;
+}
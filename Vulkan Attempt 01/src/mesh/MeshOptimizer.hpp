@@ -0,0 +1,29 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "MeshData.hpp"
+
+using namespace std;
+
+//reorders triangles and vertices of a mesh without changing what it draws, triangles keep their winding
+namespace com::gelunox::vulcanUtils::MeshOptimizer
+{
+	//all three passes on every mesh, in the order they have to run
+	void optimize( MeshData& data );
+
+	//Tom Forsyth's linear-speed vertex cache optimisation, greedy on a scored 32 entry lru cache
+	//https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html
+	void optimizeVertexCache( uint32_t * indices, size_t indexCount, uint32_t vertexCount );
+
+	//splits the cache optimised order into clusters where it restarts anyway and sorts them outside in, like Sander et al. 2007
+	//front facing outer clusters are drawn first so they occlude the inner ones, at almost no cost in cache misses
+	void optimizeOverdraw( uint32_t * indices, size_t indexCount, const Vertex * vertices, uint32_t vertexCount );
+
+	//renumbers vertices in the order the indices first use them, so vertex fetch walks memory forward
+	void optimizeVertexFetch( Vertex * vertices, uint32_t vertexCount, uint32_t * indices, size_t indexCount );
+
+	//average cache misses per triangle on a fifo cache, 0.5 is about the best a regular grid can do, 3 is no reuse at all
+	float getAverageCacheMissRatio( const uint32_t * indices, size_t indexCount, uint32_t vertexCount, uint32_t cacheSize = 16 );
+}
@@ -0,0 +1,111 @@
+#include "CpuProfiler.hpp"
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+using namespace com::gelunox::vulcanUtils;
+using namespace std;
+
+atomic<bool> CpuProfiler::enabled( false );
+
+//written by its own thread only, head is published with release so a dump sees complete events
+struct ThreadEvents
+{
+	uint32_t threadId;
+	vector<CpuEvent> ring;
+	atomic<uint64_t> head;
+
+	ThreadEvents( uint32_t threadId ) : threadId( threadId ), ring( CpuProfiler::RING_CAPACITY ), head( 0 ) {}
+};
+
+//rings are never freed before exit, a thread that ended still shows up in later dumps
+static mutex registryLock;
+static vector<unique_ptr<ThreadEvents>> registry;
+
+static thread_local ThreadEvents * threadEvents = nullptr;
+
+static const chrono::steady_clock::time_point epoch = chrono::steady_clock::now();
+
+static ThreadEvents * registerThread()
+{
+	lock_guard<mutex> guard( registryLock );
+
+	registry.push_back( make_unique<ThreadEvents>( static_cast<uint32_t>(registry.size()) ) );
+	return registry.back().get();
+}
+
+int64_t CpuProfiler::now()
+{
+	return chrono::duration_cast<chrono::nanoseconds>( chrono::steady_clock::now() - epoch ).count();
+}
+
+void CpuProfiler::record( const char * name, int64_t startNs, int64_t endNs )
+{
+	if (threadEvents == nullptr)
+	{
+		threadEvents = registerThread();
+	}
+
+	uint64_t head = threadEvents->head.load( memory_order_relaxed );
+
+	CpuEvent& event = threadEvents->ring[head % RING_CAPACITY];
+	event.name = name;
+	event.startNs = startNs;
+	event.durationNs = endNs - startNs;
+
+	threadEvents->head.store( head + 1, memory_order_release );
+}
+
+void CpuProfiler::writeChromeTrace( ostream& out )
+{
+	lock_guard<mutex> guard( registryLock );
+
+	//a writer can overwrite the oldest slots while they are copied, keep clear of them
+	const uint64_t overwriteMargin = RING_CAPACITY / 16;
+
+	//microseconds, the default six significant digits would lose sub millisecond detail after a second
+	ios::fmtflags flags = out.flags();
+	streamsize precision = out.precision();
+	out << fixed << setprecision( 3 );
+
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	bool first = true;
+
+	for (auto& thread : registry)
+	{
+		uint64_t head = thread->head.load( memory_order_acquire );
+		uint64_t oldest = head > RING_CAPACITY - overwriteMargin ? head - (RING_CAPACITY - overwriteMargin) : 0;
+
+		for (uint64_t i = oldest; i < head; i++)
+		{
+			const CpuEvent& event = thread->ring[i % RING_CAPACITY];
+
+			out << (first ? "" : ",") << "\n{\"name\":\"" << event.name
+				<< "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread->threadId
+				<< ",\"ts\":" << event.startNs / 1000.0
+				<< ",\"dur\":" << event.durationNs / 1000.0 << "}";
+			first = false;
+		}
+	}
+
+	out << "\n]}" << endl;
+
+	out.flags( flags );
+	out.precision( precision );
+}
+
+void CpuProfiler::writeChromeTrace( const string& path )
+{
+	ofstream file( path, ios::trunc );
+
+	if (!file.is_open())
+	{
+		throw runtime_error( "can't open file" );
+	}
+
+	writeChromeTrace( file );
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <ostream>
+
+using namespace std;
+
+namespace com::gelunox::vulcanUtils
+{
+	struct CpuEvent
+	{
+		//string literal, only the pointer is stored
+		const char * name;
+		int64_t startNs;
+		int64_t durationNs;
+	};
+
+	//records CpuScopes into a ring buffer per thread and writes them out as chrome trace events
+	//each thread only ever writes its own ring, so recording takes no lock, only registering a new thread does
+	//open the json in chrome://tracing or https://ui.perfetto.dev
+	class CpuProfiler
+	{
+	private:
+		static atomic<bool> enabled;
+
+	public:
+		//per thread, the oldest events are overwritten once a ring is full
+		static const size_t RING_CAPACITY = 1 << 16;
+
+		static void setEnabled( bool enabled ) { CpuProfiler::enabled.store( enabled, memory_order_relaxed ); }
+		static bool isEnabled() { return enabled.load( memory_order_relaxed ); }
+
+		static int64_t now();
+		static void record( const char * name, int64_t startNs, int64_t endNs );
+
+		//safe while other threads keep recording, events that may be mid-overwrite are left out
+		static void writeChromeTrace( ostream& out );
+		static void writeChromeTrace( const string& path );
+	};
+
+	//times its own lifetime, a single relaxed load when recording is disabled
+	class CpuScope
+	{
+	private:
+		const char * name = nullptr;
+		int64_t startNs;
+
+	public:
+		CpuScope( const char * name )
+		{
+			if (CpuProfiler::isEnabled())
+			{
+				this->name = name;
+				startNs = CpuProfiler::now();
+			}
+		}
+
+		~CpuScope()
+		{
+			if (name != nullptr)
+			{
+				CpuProfiler::record( name, startNs, CpuProfiler::now() );
+			}
+		}
+
+		CpuScope( const CpuScope& ) = delete;
+		CpuScope& operator=( const CpuScope& ) = delete;
+	};
+}
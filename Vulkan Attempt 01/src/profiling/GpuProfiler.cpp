@@ -0,0 +1,181 @@
+#include "GpuProfiler.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace com::gelunox::vulcanUtils;
+using namespace std;
+
+GpuProfiler::GpuProfiler( VkPhysicalDevice physicalDevice, VkDevice device, uint32_t queueFamily, uint32_t framesInFlight,
+	uint32_t maxScopes, size_t sampleCount )
+	: device( device ), maxScopes( maxScopes ), sampleCount( sampleCount )
+{
+	VkPhysicalDeviceProperties deviceProps;
+	vkGetPhysicalDeviceProperties( physicalDevice, &deviceProps );
+
+	uint32_t familyCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties( physicalDevice, &familyCount, nullptr );
+	vector<VkQueueFamilyProperties> families( familyCount );
+	vkGetPhysicalDeviceQueueFamilyProperties( physicalDevice, &familyCount, families.data() );
+
+	uint32_t validBits = queueFamily < familyCount ? families[queueFamily].timestampValidBits : 0;
+
+	timestampPeriod = deviceProps.limits.timestampPeriod;
+	timestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+	supported = validBits > 0 && timestampPeriod > 0.0;
+
+	if (!supported)
+	{
+		return;
+	}
+
+	VkQueryPoolCreateInfo poolInfo = {};
+	poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	poolInfo.queryCount = maxScopes * 2;
+
+	frames.resize( framesInFlight );
+
+	for (FrameQueries& frame : frames)
+	{
+		if (vkCreateQueryPool( device, &poolInfo, nullptr, &frame.pool ) != VK_SUCCESS)
+		{
+			throw runtime_error( "timestamp query pool creation failed" );
+		}
+
+		frame.names.reserve( maxScopes );
+	}
+}
+
+GpuProfiler::~GpuProfiler()
+{
+	for (FrameQueries& frame : frames)
+	{
+		vkDestroyQueryPool( device, frame.pool, nullptr );
+	}
+}
+
+void GpuProfiler::beginFrame( VkCommandBuffer cmdBuffer, uint32_t frameIndex )
+{
+	if (!supported)
+	{
+		return;
+	}
+
+	current = &frames[frameIndex];
+
+	if (current->recorded)
+	{
+		collect( *current );
+	}
+
+	current->names.clear();
+	current->recorded = true;
+
+	//queries must be reset before every reuse, and outside of a render pass
+	vkCmdResetQueryPool( cmdBuffer, current->pool, 0, maxScopes * 2 );
+}
+
+uint32_t GpuProfiler::beginScope( VkCommandBuffer cmdBuffer, const char * name )
+{
+	//out of queries, the scope is silently not measured
+	if (!supported || current == nullptr || current->names.size() >= maxScopes)
+	{
+		return NO_SCOPE;
+	}
+
+	uint32_t scope = static_cast<uint32_t>(current->names.size());
+	current->names.push_back( name );
+
+	vkCmdWriteTimestamp( cmdBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, current->pool, scope * 2 );
+	return scope;
+}
+
+void GpuProfiler::endScope( VkCommandBuffer cmdBuffer, uint32_t scope )
+{
+	if (scope == NO_SCOPE)
+	{
+		return;
+	}
+
+	//written once every earlier command has finished
+	vkCmdWriteTimestamp( cmdBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, current->pool, scope * 2 + 1 );
+}
+
+void GpuProfiler::collect( FrameQueries& frame )
+{
+	if (frame.names.empty())
+	{
+		return;
+	}
+
+	uint32_t queryCount = static_cast<uint32_t>(frame.names.size()) * 2;
+	vector<uint64_t> ticks( queryCount );
+
+	//no WAIT flag, the frame's fence has signaled, anything not ready is dropped rather than waited for
+	VkResult result = vkGetQueryPoolResults( device, frame.pool, 0, queryCount, ticks.size() * sizeof( uint64_t ),
+		ticks.data(), sizeof( uint64_t ), VK_QUERY_RESULT_64_BIT );
+
+	if (result != VK_SUCCESS)
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < frame.names.size(); i++)
+	{
+		uint64_t elapsed = (ticks[i * 2 + 1] - ticks[i * 2]) & timestampMask;
+		double ms = elapsed * timestampPeriod / 1000000.0;
+
+		ScopeSamples& scope = timings[frame.names[i]];
+
+		if (scope.samples.size() < sampleCount)
+		{
+			scope.samples.push_back( ms );
+		}
+		else
+		{
+			scope.samples[scope.next] = ms;
+		}
+		scope.next = (scope.next + 1) % sampleCount;
+	}
+}
+
+map<string, GpuScopeStats> GpuProfiler::getStats()
+{
+	map<string, GpuScopeStats> stats;
+
+	for (auto& timing : timings)
+	{
+		const vector<double>& samples = timing.second.samples;
+		GpuScopeStats& scope = stats[timing.first];
+
+		scope.samples = static_cast<uint32_t>(samples.size());
+		scope.minMs = *min_element( samples.begin(), samples.end() );
+		scope.maxMs = *max_element( samples.begin(), samples.end() );
+
+		for (double ms : samples)
+		{
+			scope.avgMs += ms / samples.size();
+		}
+	}
+
+	return stats;
+}
+
+void GpuProfiler::report( ostream& out )
+{
+	if (!supported)
+	{
+		out << "gpu timestamps not supported on this queue" << endl;
+		return;
+	}
+
+	for (auto& scope : getStats())
+	{
+		out << "gpu " << scope.first
+			<< " | min: " << scope.second.minMs << "ms"
+			<< " | avg: " << scope.second.avgMs << "ms"
+			<< " | max: " << scope.second.maxMs << "ms"
+			<< " | over " << scope.second.samples << " frames" << endl;
+	}
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <map>
+#include <string>
+#include <ostream>
+
+using namespace std;
+
+namespace com::gelunox::vulcanUtils
+{
+	struct GpuScopeStats
+	{
+		double minMs = 0.0;
+		double avgMs = 0.0;
+		double maxMs = 0.0;
+		uint32_t samples = 0;
+	};
+
+	//gpu time of named command buffer regions, measured with a timestamp query pool per frame in flight
+	//results are read back when the frame slot comes around again, its fence has signaled by then so nothing blocks
+	class GpuProfiler
+	{
+	private:
+		struct FrameQueries
+		{
+			VkQueryPool pool;
+			//one entry per scope, scope i owns queries 2i and 2i+1
+			vector<const char*> names;
+			bool recorded = false;
+		};
+
+		//the last sampleCount timings of a scope, overwritten round robin
+		struct ScopeSamples
+		{
+			vector<double> samples;
+			size_t next = 0;
+		};
+
+		VkDevice device;
+		//nanoseconds per timestamp tick
+		double timestampPeriod;
+		//timestamps only have timestampValidBits significant bits, differences wrap around at that width
+		uint64_t timestampMask;
+		bool supported;
+
+		uint32_t maxScopes;
+		size_t sampleCount;
+
+		vector<FrameQueries> frames;
+		FrameQueries * current = nullptr;
+
+		map<string, ScopeSamples> timings;
+
+	public:
+		static const uint32_t NO_SCOPE = ~0u;
+
+		//queueFamily is the family the profiled command buffers are submitted to
+		GpuProfiler( VkPhysicalDevice physicalDevice, VkDevice device, uint32_t queueFamily, uint32_t framesInFlight,
+			uint32_t maxScopes = 32, size_t sampleCount = 120 );
+		~GpuProfiler();
+
+		//false when the queue family has no timestamp support, every call is then a no-op
+		bool isSupported() { return supported; }
+
+		//call right after vkBeginCommandBuffer, once the frame slot's fence has signaled
+		//collects the slot's previous results and resets its queries in cmdBuffer
+		void beginFrame( VkCommandBuffer cmdBuffer, uint32_t frameIndex );
+
+		//name must outlive the frame, string literals are the intended use
+		uint32_t beginScope( VkCommandBuffer cmdBuffer, const char * name );
+		void endScope( VkCommandBuffer cmdBuffer, uint32_t scope );
+
+		//rolling min/avg/max over the last sampleCount frames per scope
+		map<string, GpuScopeStats> getStats();
+		void report( ostream& out );
+
+	private:
+		void collect( FrameQueries& frame );
+	};
+
+	//times the commands recorded into cmdBuffer during its lifetime
+	class GpuScope
+	{
+	private:
+		GpuProfiler& profiler;
+		VkCommandBuffer cmdBuffer;
+		uint32_t scope;
+
+	public:
+		GpuScope( GpuProfiler& profiler, VkCommandBuffer cmdBuffer, const char * name )
+			: profiler( profiler ), cmdBuffer( cmdBuffer ), scope( profiler.beginScope( cmdBuffer, name ) ) {}
+		~GpuScope() { profiler.endScope( cmdBuffer, scope ); }
+
+		GpuScope( const GpuScope& ) = delete;
+		GpuScope& operator=( const GpuScope& ) = delete;
+	};
+}
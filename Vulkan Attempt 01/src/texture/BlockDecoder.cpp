@@ -0,0 +1,486 @@
+#include "BlockDecoder.hpp"
+
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+
+using namespace com::gelunox::vulcanUtils;
+using namespace std;
+
+//https://learn.microsoft.com/windows/win32/direct3d11/bc7-format-mode-reference
+//BC1 to BC5 are the same S3TC blocks under their DXT names, BC7 follows the mode reference above
+
+namespace
+{
+	struct Bc7Mode
+	{
+		uint32_t subsets;
+		uint32_t partitionBits;
+		uint32_t rotationBits;
+		uint32_t indexSelectionBits;
+		uint32_t colorBits;
+		uint32_t alphaBits;
+		uint32_t endpointPBits;
+		uint32_t sharedPBits;
+		uint32_t indexBits;
+		uint32_t secondaryIndexBits;
+	};
+
+	const Bc7Mode BC7_MODES[8] =
+	{
+		{ 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+		{ 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+		{ 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+		{ 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+		{ 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+		{ 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+		{ 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+		{ 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 }
+	};
+
+	//bit i is the subset of texel i
+	const uint16_t BC7_PARTITIONS2[64] =
+	{
+		0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80,
+		0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+		0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE,
+		0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+		0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A,
+		0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+		0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C,
+		0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22
+	};
+
+	const uint8_t BC7_PARTITIONS3[64][16] =
+	{
+		{ 0,0,1,1,0,0,1,1,0,2,2,1,2,2,2,2 }, { 0,0,0,1,0,0,1,1,2,2,1,1,2,2,2,1 }, { 0,0,0,0,2,0,0,1,2,2,1,1,2,2,1,1 }, { 0,2,2,2,0,0,2,2,0,0,1,1,0,1,1,1 },
+		{ 0,0,0,0,0,0,0,0,1,1,2,2,1,1,2,2 }, { 0,0,1,1,0,0,1,1,0,0,2,2,0,0,2,2 }, { 0,0,2,2,0,0,2,2,1,1,1,1,1,1,1,1 }, { 0,0,1,1,0,0,1,1,2,2,1,1,2,2,1,1 },
+		{ 0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2 }, { 0,0,0,0,1,1,1,1,1,1,1,1,2,2,2,2 }, { 0,0,0,0,1,1,1,1,2,2,2,2,2,2,2,2 }, { 0,0,1,2,0,0,1,2,0,0,1,2,0,0,1,2 },
+		{ 0,1,1,2,0,1,1,2,0,1,1,2,0,1,1,2 }, { 0,1,2,2,0,1,2,2,0,1,2,2,0,1,2,2 }, { 0,0,1,1,0,1,1,2,1,1,2,2,1,2,2,2 }, { 0,0,1,1,2,0,0,1,2,2,0,0,2,2,2,0 },
+		{ 0,0,0,1,0,0,1,1,0,1,1,2,1,1,2,2 }, { 0,1,1,1,0,0,1,1,2,0,0,1,2,2,0,0 }, { 0,0,0,0,1,1,2,2,1,1,2,2,1,1,2,2 }, { 0,0,2,2,0,0,2,2,0,0,2,2,1,1,1,1 },
+		{ 0,1,1,1,0,1,1,1,0,2,2,2,0,2,2,2 }, { 0,0,0,1,0,0,0,1,2,2,2,1,2,2,2,1 }, { 0,0,0,0,0,0,1,1,0,1,2,2,0,1,2,2 }, { 0,0,0,0,1,1,0,0,2,2,1,0,2,2,1,0 },
+		{ 0,1,2,2,0,1,2,2,0,0,1,1,0,0,0,0 }, { 0,0,1,2,0,0,1,2,1,1,2,2,2,2,2,2 }, { 0,1,1,0,1,2,2,1,1,2,2,1,0,1,1,0 }, { 0,0,0,0,0,1,1,0,1,2,2,1,1,2,2,1 },
+		{ 0,0,2,2,1,1,0,2,1,1,0,2,0,0,2,2 }, { 0,1,1,0,0,1,1,0,2,0,0,2,2,2,2,2 }, { 0,0,1,1,0,1,2,2,0,1,2,2,0,0,1,1 }, { 0,0,0,0,2,0,0,0,2,2,1,1,2,2,2,1 },
+		{ 0,0,0,0,0,0,0,2,1,1,2,2,1,2,2,2 }, { 0,2,2,2,0,0,2,2,0,0,1,2,0,0,1,1 }, { 0,0,1,1,0,0,1,2,0,0,2,2,0,2,2,2 }, { 0,1,2,0,0,1,2,0,0,1,2,0,0,1,2,0 },
+		{ 0,0,0,0,1,1,1,1,2,2,2,2,0,0,0,0 }, { 0,1,2,0,1,2,0,1,2,0,1,2,0,1,2,0 }, { 0,1,2,0,2,0,1,2,1,2,0,1,0,1,2,0 }, { 0,0,1,1,2,2,0,0,1,1,2,2,0,0,1,1 },
+		{ 0,0,1,1,1,1,2,2,2,2,0,0,0,0,1,1 }, { 0,1,0,1,0,1,0,1,2,2,2,2,2,2,2,2 }, { 0,0,0,0,0,0,0,0,2,1,2,1,2,1,2,1 }, { 0,0,2,2,1,1,2,2,0,0,2,2,1,1,2,2 },
+		{ 0,0,2,2,0,0,1,1,0,0,2,2,0,0,1,1 }, { 0,2,2,0,1,2,2,1,0,2,2,0,1,2,2,1 }, { 0,1,0,1,2,2,2,2,2,2,2,2,0,1,0,1 }, { 0,0,0,0,2,1,2,1,2,1,2,1,2,1,2,1 },
+		{ 0,1,0,1,0,1,0,1,0,1,0,1,2,2,2,2 }, { 0,2,2,2,0,1,1,1,0,2,2,2,0,1,1,1 }, { 0,0,0,2,1,1,1,2,0,0,0,2,1,1,1,2 }, { 0,0,0,0,2,1,1,2,2,1,1,2,2,1,1,2 },
+		{ 0,2,2,2,0,1,1,1,0,1,1,1,0,2,2,2 }, { 0,0,0,2,1,1,1,2,1,1,1,2,0,0,0,2 }, { 0,1,1,0,0,1,1,0,0,1,1,0,2,2,2,2 }, { 0,0,0,0,0,0,0,0,2,1,1,2,2,1,1,2 },
+		{ 0,1,1,0,0,1,1,0,2,2,2,2,2,2,2,2 }, { 0,0,2,2,0,0,1,1,0,0,1,1,0,0,2,2 }, { 0,0,2,2,1,1,2,2,1,1,2,2,0,0,2,2 }, { 0,0,0,0,0,0,0,0,0,0,0,0,2,1,1,2 },
+		{ 0,0,0,2,0,0,0,1,0,0,0,2,0,0,0,1 }, { 0,2,2,2,1,2,2,2,0,2,2,2,1,2,2,2 }, { 0,1,0,1,2,2,2,2,2,2,2,2,2,2,2,2 }, { 0,1,1,1,2,0,1,1,2,2,0,1,2,2,2,0 }
+	};
+
+	//texels whose index is stored with one bit less, texel 0 is always the anchor of subset 0
+	const uint8_t BC7_ANCHORS2[64] =
+	{
+		15,15,15,15,15,15,15,15, 15,15,15,15,15,15,15,15,
+		15, 2, 8, 2, 2, 8, 8,15,  2, 8, 2, 2, 8, 8, 2, 2,
+		15,15, 6, 8, 2, 8,15,15,  2, 8, 2, 2, 2,15,15, 6,
+		 6, 2, 6, 8,15,15, 2, 2, 15,15,15,15,15, 2, 2,15
+	};
+
+	const uint8_t BC7_ANCHORS3_SECOND[64] =
+	{
+		 3, 3,15,15, 8, 3,15,15,  8, 8, 6, 6, 6, 5, 3, 3,
+		 3, 3, 8,15, 3, 3, 6,10,  5, 8, 8, 6, 8, 5,15,15,
+		 8,15, 3, 5, 6,10, 8,15, 15, 3,15, 5,15,15,15,15,
+		 3,15, 5, 5, 5, 8, 5,10,  5,10, 8,13,15,12, 3, 3
+	};
+
+	const uint8_t BC7_ANCHORS3_THIRD[64] =
+	{
+		15, 8, 8, 3,15,15, 3, 8, 15,15,15,15,15,15,15, 8,
+		15, 8,15, 3,15, 8,15, 8,  3,15, 6,10,15,15,10, 8,
+		15, 3,15,10,10, 8, 9,10,  6,15, 8,15, 3, 6, 6, 8,
+		15, 3,15,15,15,15,15,15, 15,15,15,15, 3,15,15, 8
+	};
+
+	const uint8_t BC7_WEIGHTS2[4] = { 0, 21, 43, 64 };
+	const uint8_t BC7_WEIGHTS3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+	const uint8_t BC7_WEIGHTS4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	//least significant bit first, like the blocks are laid out
+	class BitReader
+	{
+	private:
+		const uint8_t * data;
+		uint32_t position = 0;
+
+	public:
+		BitReader( const uint8_t * data ) : data( data ) {}
+
+		uint32_t read( uint32_t count )
+		{
+			uint32_t value = 0;
+			for (uint32_t i = 0; i < count; i++, position++)
+			{
+				value |= ((data[position >> 3] >> (position & 7)) & 1) << i;
+			}
+			return value;
+		}
+	};
+
+	uint8_t expandBits( uint32_t value, uint32_t bits )
+	{
+		value <<= 8 - bits;
+		return static_cast<uint8_t>(value | (value >> bits));
+	}
+
+	uint8_t interpolate( uint8_t e0, uint8_t e1, uint8_t weight )
+	{
+		return static_cast<uint8_t>(((64 - weight) * e0 + weight * e1 + 32) >> 6);
+	}
+
+	const uint8_t * getWeights( uint32_t bits )
+	{
+		return bits == 2 ? BC7_WEIGHTS2 : bits == 3 ? BC7_WEIGHTS3 : BC7_WEIGHTS4;
+	}
+
+	void decodeBc7( const uint8_t * block, uint8_t texels[16][4] )
+	{
+		BitReader bits( block );
+
+		uint32_t modeIndex = 0;
+		while (modeIndex < 8 && bits.read( 1 ) == 0)
+		{
+			modeIndex++;
+		}
+
+		//reserved mode, decodes to transparent black
+		if (modeIndex == 8)
+		{
+			memset( texels, 0, 16 * 4 );
+			return;
+		}
+
+		const Bc7Mode& mode = BC7_MODES[modeIndex];
+		uint32_t partition = bits.read( mode.partitionBits );
+		uint32_t rotation = bits.read( mode.rotationBits );
+		uint32_t indexSelection = bits.read( mode.indexSelectionBits );
+
+		uint32_t endpointCount = mode.subsets * 2;
+		uint32_t endpoints[6][4] = {};
+
+		for (uint32_t channel = 0; channel < 3; channel++)
+		{
+			for (uint32_t e = 0; e < endpointCount; e++)
+			{
+				endpoints[e][channel] = bits.read( mode.colorBits );
+			}
+		}
+		for (uint32_t e = 0; e < endpointCount; e++)
+		{
+			endpoints[e][3] = bits.read( mode.alphaBits );
+		}
+
+		uint32_t pBits[6] = {};
+		if (mode.endpointPBits)
+		{
+			for (uint32_t e = 0; e < endpointCount; e++)
+			{
+				pBits[e] = bits.read( 1 );
+			}
+		}
+		if (mode.sharedPBits)
+		{
+			for (uint32_t s = 0; s < mode.subsets; s++)
+			{
+				pBits[s * 2] = pBits[s * 2 + 1] = bits.read( 1 );
+			}
+		}
+
+		bool hasPBits = mode.endpointPBits || mode.sharedPBits;
+		uint32_t colorPrecision = mode.colorBits + (hasPBits ? 1 : 0);
+		uint32_t alphaPrecision = mode.alphaBits ? mode.alphaBits + (hasPBits ? 1 : 0) : 0;
+
+		uint8_t colors[6][4];
+		for (uint32_t e = 0; e < endpointCount; e++)
+		{
+			for (uint32_t channel = 0; channel < 4; channel++)
+			{
+				uint32_t precision = channel < 3 ? colorPrecision : alphaPrecision;
+				uint32_t value = hasPBits ? endpoints[e][channel] << 1 | pBits[e] : endpoints[e][channel];
+
+				colors[e][channel] = precision ? expandBits( value, precision ) : 255;
+			}
+		}
+
+		uint32_t subsets[16];
+		bool anchors[16] = { true };
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			subsets[i] = mode.subsets == 1 ? 0 : mode.subsets == 2 ? (BC7_PARTITIONS2[partition] >> i) & 1 : BC7_PARTITIONS3[partition][i];
+		}
+		if (mode.subsets == 2)
+		{
+			anchors[BC7_ANCHORS2[partition]] = true;
+		}
+		else if (mode.subsets == 3)
+		{
+			anchors[BC7_ANCHORS3_SECOND[partition]] = true;
+			anchors[BC7_ANCHORS3_THIRD[partition]] = true;
+		}
+
+		uint32_t indices[16];
+		uint32_t secondaryIndices[16] = {};
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			indices[i] = bits.read( mode.indexBits - (anchors[i] ? 1 : 0) );
+		}
+		if (mode.secondaryIndexBits)
+		{
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				secondaryIndices[i] = bits.read( mode.secondaryIndexBits - (i == 0 ? 1 : 0) );
+			}
+		}
+
+		//with two index sets the color uses the first and alpha the second, unless the selection bit swaps them
+		const uint32_t * colorIndices = indices;
+		const uint32_t * alphaIndices = mode.secondaryIndexBits ? secondaryIndices : indices;
+		uint32_t colorIndexBits = mode.indexBits;
+		uint32_t alphaIndexBits = mode.secondaryIndexBits ? mode.secondaryIndexBits : mode.indexBits;
+
+		if (indexSelection)
+		{
+			swap( colorIndices, alphaIndices );
+			swap( colorIndexBits, alphaIndexBits );
+		}
+
+		const uint8_t * colorWeights = getWeights( colorIndexBits );
+		const uint8_t * alphaWeights = getWeights( alphaIndexBits );
+
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			const uint8_t * e0 = colors[subsets[i] * 2];
+			const uint8_t * e1 = colors[subsets[i] * 2 + 1];
+
+			for (uint32_t channel = 0; channel < 3; channel++)
+			{
+				texels[i][channel] = interpolate( e0[channel], e1[channel], colorWeights[colorIndices[i]] );
+			}
+			texels[i][3] = interpolate( e0[3], e1[3], alphaWeights[alphaIndices[i]] );
+
+			if (rotation)
+			{
+				swap( texels[i][3], texels[i][rotation - 1] );
+			}
+		}
+	}
+
+	void decodeColor565( uint16_t color, uint8_t rgba[4] )
+	{
+		uint32_t r = (color >> 11) & 31;
+		uint32_t g = (color >> 5) & 63;
+		uint32_t b = color & 31;
+
+		rgba[0] = static_cast<uint8_t>(r << 3 | r >> 2);
+		rgba[1] = static_cast<uint8_t>(g << 2 | g >> 4);
+		rgba[2] = static_cast<uint8_t>(b << 3 | b >> 2);
+		rgba[3] = 255;
+	}
+
+	//BC2 and BC3 always use four colors, BC1 switches to three and transparent black when c0 <= c1
+	void decodeBc1( const uint8_t * block, uint8_t texels[16][4], bool alwaysFourColors, bool punchThrough )
+	{
+		uint16_t c0 = static_cast<uint16_t>(block[0] | block[1] << 8);
+		uint16_t c1 = static_cast<uint16_t>(block[2] | block[3] << 8);
+		uint32_t indices = block[4] | block[5] << 8 | block[6] << 16 | static_cast<uint32_t>(block[7]) << 24;
+
+		uint8_t palette[4][4];
+		decodeColor565( c0, palette[0] );
+		decodeColor565( c1, palette[1] );
+
+		for (uint32_t channel = 0; channel < 3; channel++)
+		{
+			if (alwaysFourColors || c0 > c1)
+			{
+				palette[2][channel] = static_cast<uint8_t>((2 * palette[0][channel] + palette[1][channel] + 1) / 3);
+				palette[3][channel] = static_cast<uint8_t>((palette[0][channel] + 2 * palette[1][channel] + 1) / 3);
+			}
+			else
+			{
+				palette[2][channel] = static_cast<uint8_t>((palette[0][channel] + palette[1][channel] + 1) / 2);
+				palette[3][channel] = 0;
+			}
+		}
+		palette[2][3] = 255;
+		palette[3][3] = !alwaysFourColors && c0 <= c1 && punchThrough ? 0 : 255;
+
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			memcpy( texels[i], palette[(indices >> (i * 2)) & 3], 4 );
+		}
+	}
+
+	//a single channel of BC3 alpha, BC4 and BC5
+	void decodeBc4( const uint8_t * block, uint8_t values[16] )
+	{
+		uint32_t a0 = block[0];
+		uint32_t a1 = block[1];
+
+		uint8_t palette[8];
+		palette[0] = static_cast<uint8_t>(a0);
+		palette[1] = static_cast<uint8_t>(a1);
+
+		if (a0 > a1)
+		{
+			for (uint32_t i = 1; i < 7; i++)
+			{
+				palette[i + 1] = static_cast<uint8_t>(((7 - i) * a0 + i * a1 + 3) / 7);
+			}
+		}
+		else
+		{
+			for (uint32_t i = 1; i < 5; i++)
+			{
+				palette[i + 1] = static_cast<uint8_t>(((5 - i) * a0 + i * a1 + 2) / 5);
+			}
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+
+		uint64_t indices = 0;
+		for (uint32_t i = 0; i < 6; i++)
+		{
+			indices |= static_cast<uint64_t>(block[2 + i]) << (i * 8);
+		}
+
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			values[i] = palette[(indices >> (i * 3)) & 7];
+		}
+	}
+
+	void decodeBlock( VkFormat format, const uint8_t * block, uint8_t texels[16][4] )
+	{
+		uint8_t channel[16];
+
+		switch (format)
+		{
+		case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+			decodeBc1( block, texels, false, false );
+			break;
+		case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+			decodeBc1( block, texels, false, true );
+			break;
+		case VK_FORMAT_BC2_UNORM_BLOCK:
+		case VK_FORMAT_BC2_SRGB_BLOCK:
+			decodeBc1( block + 8, texels, true, false );
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				texels[i][3] = static_cast<uint8_t>(((block[i / 2] >> ((i & 1) * 4)) & 15) * 17);
+			}
+			break;
+		case VK_FORMAT_BC3_UNORM_BLOCK:
+		case VK_FORMAT_BC3_SRGB_BLOCK:
+			decodeBc1( block + 8, texels, true, false );
+			decodeBc4( block, channel );
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				texels[i][3] = channel[i];
+			}
+			break;
+		//sampled like R8 and R8G8, the missing channels read as 0 and alpha as 1
+		case VK_FORMAT_BC4_UNORM_BLOCK:
+			decodeBc4( block, channel );
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				texels[i][0] = channel[i];
+				texels[i][1] = texels[i][2] = 0;
+				texels[i][3] = 255;
+			}
+			break;
+		case VK_FORMAT_BC5_UNORM_BLOCK:
+			decodeBc4( block, channel );
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				texels[i][0] = channel[i];
+				texels[i][2] = 0;
+				texels[i][3] = 255;
+			}
+			decodeBc4( block + 8, channel );
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				texels[i][1] = channel[i];
+			}
+			break;
+		case VK_FORMAT_BC7_UNORM_BLOCK:
+		case VK_FORMAT_BC7_SRGB_BLOCK:
+			decodeBc7( block, texels );
+			break;
+		default:
+			throw invalid_argument( "no cpu decoder for this block format" );
+		}
+	}
+}
+
+bool BlockDecoder::canDecode( VkFormat format )
+{
+	switch (format)
+	{
+	case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+	case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+	case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+	case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+	case VK_FORMAT_BC2_UNORM_BLOCK:
+	case VK_FORMAT_BC2_SRGB_BLOCK:
+	case VK_FORMAT_BC3_UNORM_BLOCK:
+	case VK_FORMAT_BC3_SRGB_BLOCK:
+	case VK_FORMAT_BC4_UNORM_BLOCK:
+	case VK_FORMAT_BC5_UNORM_BLOCK:
+	case VK_FORMAT_BC7_UNORM_BLOCK:
+	case VK_FORMAT_BC7_SRGB_BLOCK:
+		return true;
+	default:
+		return false;
+	}
+}
+
+VkFormat BlockDecoder::getDecodedFormat( VkFormat format )
+{
+	switch (format)
+	{
+	case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+	case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+	case VK_FORMAT_BC2_SRGB_BLOCK:
+	case VK_FORMAT_BC3_SRGB_BLOCK:
+	case VK_FORMAT_BC7_SRGB_BLOCK:
+		return VK_FORMAT_R8G8B8A8_SRGB;
+	default:
+		return VK_FORMAT_R8G8B8A8_UNORM;
+	}
+}
+
+void BlockDecoder::decode( VkFormat format, const uint8_t * blocks, uint32_t width, uint32_t height, uint8_t * dst )
+{
+	uint32_t blockBytes = format == VK_FORMAT_BC1_RGB_UNORM_BLOCK || format == VK_FORMAT_BC1_RGB_SRGB_BLOCK
+		|| format == VK_FORMAT_BC1_RGBA_UNORM_BLOCK || format == VK_FORMAT_BC1_RGBA_SRGB_BLOCK
+		|| format == VK_FORMAT_BC4_UNORM_BLOCK ? 8 : 16;
+
+	uint32_t blocksWide = (width + 3) / 4;
+	uint32_t blocksHigh = (height + 3) / 4;
+
+	uint8_t texels[16][4];
+
+	for (uint32_t by = 0; by < blocksHigh; by++)
+	{
+		for (uint32_t bx = 0; bx < blocksWide; bx++)
+		{
+			decodeBlock( format, blocks + (static_cast<size_t>(by) * blocksWide + bx) * blockBytes, texels );
+
+			//edge blocks of levels that aren't a multiple of 4 are partially outside the image
+			uint32_t columns = min( 4u, width - bx * 4 );
+			uint32_t rows = min( 4u, height - by * 4 );
+
+			for (uint32_t y = 0; y < rows; y++)
+			{
+				uint8_t * out = dst + ((static_cast<size_t>(by) * 4 + y) * width + bx * 4) * 4;
+				memcpy( out, texels[y * 4], columns * 4 );
+			}
+		}
+	}
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <stdint.h>
+
+namespace com::gelunox::vulcanUtils::BlockDecoder
+{
+	//BC1, BC2, BC3, BC4, BC5 and BC7, the unsigned variants only
+	bool canDecode( VkFormat format );
+	//R8G8B8A8_UNORM, or its SRGB variant for SRGB blocks
+	VkFormat getDecodedFormat( VkFormat format );
+
+	//for devices without the BC formats, dst receives width * height rgba8 texels
+	void decode( VkFormat format, const uint8_t * blocks, uint32_t width, uint32_t height, uint8_t * dst );
+}
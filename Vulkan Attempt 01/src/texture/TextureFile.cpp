@@ -0,0 +1,306 @@
+#include "TextureFile.hpp"
+
+#include "../util/Util.hpp"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+
+using namespace com::gelunox::vulcanUtils;
+using namespace std;
+
+static const uint8_t KTX2_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+static const uint32_t KTX2_HEADER_SIZE = 80;
+static const uint32_t KTX2_LEVEL_SIZE = 24;
+
+static const uint32_t DDS_MAGIC = 0x20534444; //"DDS "
+static const uint32_t DDS_HEADER_SIZE = 124;
+static const uint32_t DDS_DX10_SIZE = 20;
+static const uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+static const uint32_t DDPF_FOURCC = 0x4;
+static const uint32_t DDSCAPS2_CUBEMAP = 0x200;
+static const uint32_t DDSCAPS2_VOLUME = 0x200000;
+static const uint32_t DDS_RESOURCE_MISC_TEXTURECUBE = 0x4;
+
+static uint32_t makeFourCC( const char code[4] )
+{
+	return code[0] | code[1] << 8 | code[2] << 16 | static_cast<uint32_t>(code[3]) << 24;
+}
+
+template<typename T>
+static T readAt( const AssetData& file, size_t offset )
+{
+	if (offset + sizeof( T ) > file.size())
+	{
+		throw runtime_error( "texture file is truncated" );
+	}
+
+	T value;
+	memcpy( &value, file.data() + offset, sizeof( T ) );
+	return value;
+}
+
+TextureFile TextureFile::load( const string& path )
+{
+	return load( AssetData( Util::readFile( path ) ), path );
+}
+
+TextureFile TextureFile::load( AssetData file, const string& name )
+{
+	if (file.size() >= sizeof( KTX2_IDENTIFIER ) && memcmp( file.data(), KTX2_IDENTIFIER, sizeof( KTX2_IDENTIFIER ) ) == 0)
+	{
+		return loadKtx2( move( file ) );
+	}
+
+	if (file.size() >= 4 && readAt<uint32_t>( file, 0 ) == DDS_MAGIC)
+	{
+		return loadDds( move( file ) );
+	}
+
+	return loadImage( file, name );
+}
+
+TextureFile TextureFile::fromRgba8( uint32_t width, uint32_t height, const uint8_t * pixels, bool generateMips )
+{
+	TextureFile texture;
+	texture.format = VK_FORMAT_R8G8B8A8_UNORM;
+	texture.width = width;
+	texture.height = height;
+	texture.generateMips = generateMips;
+	texture.data = AssetData( vector<char>( pixels, pixels + static_cast<size_t>(width) * height * 4 ) );
+	texture.addPackedLevels( 1, 0 );
+
+	return texture;
+}
+
+TextureFile TextureFile::loadImage( const AssetData& file, const string& path )
+{
+	int width,
+		height,
+		channels;
+
+	stbi_uc* pixels = stbi_load_from_memory( reinterpret_cast<const stbi_uc*>(file.data()), static_cast<int>(file.size()),
+		&width, &height, &channels, STBI_rgb_alpha );
+
+	if (!pixels)
+	{
+		throw runtime_error( "couldn't load image: " + path );
+	}
+
+	TextureFile texture = fromRgba8( static_cast<uint32_t>(width), static_cast<uint32_t>(height), pixels, true );
+	stbi_image_free( pixels );
+
+	return texture;
+}
+
+FormatBlock TextureFile::getFormatBlock( VkFormat format )
+{
+	switch (format)
+	{
+	case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+	case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+	case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+	case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+	case VK_FORMAT_BC4_UNORM_BLOCK:
+	case VK_FORMAT_BC4_SNORM_BLOCK:
+		return { 8, 4 };
+	case VK_FORMAT_BC2_UNORM_BLOCK:
+	case VK_FORMAT_BC2_SRGB_BLOCK:
+	case VK_FORMAT_BC3_UNORM_BLOCK:
+	case VK_FORMAT_BC3_SRGB_BLOCK:
+	case VK_FORMAT_BC5_UNORM_BLOCK:
+	case VK_FORMAT_BC5_SNORM_BLOCK:
+	case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+	case VK_FORMAT_BC6H_SFLOAT_BLOCK:
+	case VK_FORMAT_BC7_UNORM_BLOCK:
+	case VK_FORMAT_BC7_SRGB_BLOCK:
+		return { 16, 4 };
+	case VK_FORMAT_R8G8B8A8_UNORM:
+	case VK_FORMAT_R8G8B8A8_SRGB:
+		return { 4, 1 };
+	default:
+		throw invalid_argument( "unsupported texture format" );
+	}
+}
+
+bool TextureFile::isBlockCompressed( VkFormat format )
+{
+	return getFormatBlock( format ).size > 1;
+}
+
+void TextureFile::addPackedLevels( uint32_t levelCount, size_t offset )
+{
+	FormatBlock block = getFormatBlock( format );
+
+	for (uint32_t level = 0; level < levelCount; level++)
+	{
+		uint32_t levelWidth = max( width >> level, 1u );
+		uint32_t levelHeight = max( height >> level, 1u );
+		size_t size = static_cast<size_t>((levelWidth + block.size - 1) / block.size) * ((levelHeight + block.size - 1) / block.size) * block.bytes;
+
+		levels.push_back( { levelWidth, levelHeight, offset, size } );
+		offset += size;
+	}
+
+	if (offset > data.size())
+	{
+		throw runtime_error( "texture file is truncated" );
+	}
+}
+
+//https://registry.khronos.org/KTX/specs/2.0/ktxspec.v2.html
+TextureFile TextureFile::loadKtx2( AssetData file )
+{
+	TextureFile texture;
+	texture.format = static_cast<VkFormat>(readAt<uint32_t>( file, 12 ));
+	texture.width = readAt<uint32_t>( file, 20 );
+	texture.height = readAt<uint32_t>( file, 24 );
+
+	uint32_t depth = readAt<uint32_t>( file, 28 );
+	uint32_t layerCount = readAt<uint32_t>( file, 32 );
+	uint32_t faceCount = readAt<uint32_t>( file, 36 );
+	uint32_t levelCount = max( readAt<uint32_t>( file, 40 ), 1u );
+	uint32_t supercompression = readAt<uint32_t>( file, 44 );
+
+	if (depth > 1 || layerCount > 1 || faceCount != 1)
+	{
+		throw runtime_error( "only plain 2D KTX2 textures are supported" );
+	}
+	if (supercompression != 0 || texture.format == VK_FORMAT_UNDEFINED)
+	{
+		throw runtime_error( "supercompressed KTX2 textures need a transcoder" );
+	}
+
+	if (texture.width == 0 || texture.height == 0 || levelCount > Util::getMipLevelCount( texture.width, texture.height ))
+	{
+		throw runtime_error( "KTX2 texture has no size or more levels than its size allows" );
+	}
+
+	//throws for formats nothing here can upload
+	FormatBlock block = getFormatBlock( texture.format );
+
+	//the index starts at level 0 while the file stores the smallest level first, the levels point into the file wherever they are
+	for (uint32_t level = 0; level < levelCount; level++)
+	{
+		size_t entry = KTX2_HEADER_SIZE + level * KTX2_LEVEL_SIZE;
+		uint64_t byteOffset = readAt<uint64_t>( file, entry );
+		uint64_t byteLength = readAt<uint64_t>( file, entry + 8 );
+
+		if (byteLength > file.size() || byteOffset > file.size() - byteLength)
+		{
+			throw runtime_error( "texture file is truncated" );
+		}
+
+		uint32_t levelWidth = max( texture.width >> level, 1u );
+		uint32_t levelHeight = max( texture.height >> level, 1u );
+
+		//the upload and the block decoder read as much as the dimensions ask for, whatever byteLength claims
+		uint64_t expected = uint64_t( (levelWidth + block.size - 1) / block.size ) * ((levelHeight + block.size - 1) / block.size) * block.bytes;
+		if (byteLength < expected)
+		{
+			throw runtime_error( "KTX2 level is smaller than its size and format need" );
+		}
+
+		texture.levels.push_back( { levelWidth, levelHeight, static_cast<size_t>(byteOffset), static_cast<size_t>(byteLength) } );
+	}
+
+	texture.data = move( file );
+
+	return texture;
+}
+
+//https://learn.microsoft.com/windows/win32/direct3ddds/dds-header
+TextureFile TextureFile::loadDds( AssetData file )
+{
+	TextureFile texture;
+
+	uint32_t flags = readAt<uint32_t>( file, 4 + 4 );
+	texture.height = readAt<uint32_t>( file, 4 + 8 );
+	texture.width = readAt<uint32_t>( file, 4 + 12 );
+	uint32_t mipMapCount = readAt<uint32_t>( file, 4 + 24 );
+	uint32_t pixelFlags = readAt<uint32_t>( file, 4 + 76 );
+	uint32_t fourCC = readAt<uint32_t>( file, 4 + 80 );
+	uint32_t caps2 = readAt<uint32_t>( file, 4 + 108 );
+
+	if (!(pixelFlags & DDPF_FOURCC))
+	{
+		throw runtime_error( "only block compressed or DX10 DDS textures are supported" );
+	}
+	if (caps2 & (DDSCAPS2_CUBEMAP | DDSCAPS2_VOLUME))
+	{
+		throw runtime_error( "only plain 2D DDS textures are supported" );
+	}
+
+	uint32_t levelCount = flags & DDSD_MIPMAPCOUNT ? max( mipMapCount, 1u ) : 1;
+
+	//addPackedLevels walks every level before its size check, a bogus count would run it for billions of levels
+	if (texture.width == 0 || texture.height == 0 || levelCount > Util::getMipLevelCount( texture.width, texture.height ))
+	{
+		throw runtime_error( "DDS texture has no size or more levels than its size allows" );
+	}
+
+	size_t dataOffset = 4 + DDS_HEADER_SIZE;
+
+	if (fourCC == makeFourCC( "DX10" ))
+	{
+		uint32_t dxgiFormat = readAt<uint32_t>( file, dataOffset );
+		uint32_t miscFlag = readAt<uint32_t>( file, dataOffset + 8 );
+		uint32_t arraySize = readAt<uint32_t>( file, dataOffset + 12 );
+
+		if (arraySize > 1 || miscFlag & DDS_RESOURCE_MISC_TEXTURECUBE)
+		{
+			throw runtime_error( "only plain 2D DDS textures are supported" );
+		}
+
+		texture.format = fromDxgi( dxgiFormat );
+		dataOffset += DDS_DX10_SIZE;
+	}
+	else
+	{
+		texture.format = fromFourCC( fourCC );
+	}
+
+	texture.data = move( file );
+	texture.addPackedLevels( levelCount, dataOffset );
+
+	return texture;
+}
+
+VkFormat TextureFile::fromDxgi( uint32_t dxgiFormat )
+{
+	switch (dxgiFormat)
+	{
+	case 28: return VK_FORMAT_R8G8B8A8_UNORM;
+	case 29: return VK_FORMAT_R8G8B8A8_SRGB;
+	case 71: return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+	case 72: return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+	case 74: return VK_FORMAT_BC2_UNORM_BLOCK;
+	case 75: return VK_FORMAT_BC2_SRGB_BLOCK;
+	case 77: return VK_FORMAT_BC3_UNORM_BLOCK;
+	case 78: return VK_FORMAT_BC3_SRGB_BLOCK;
+	case 80: return VK_FORMAT_BC4_UNORM_BLOCK;
+	case 81: return VK_FORMAT_BC4_SNORM_BLOCK;
+	case 83: return VK_FORMAT_BC5_UNORM_BLOCK;
+	case 84: return VK_FORMAT_BC5_SNORM_BLOCK;
+	case 95: return VK_FORMAT_BC6H_UFLOAT_BLOCK;
+	case 96: return VK_FORMAT_BC6H_SFLOAT_BLOCK;
+	case 98: return VK_FORMAT_BC7_UNORM_BLOCK;
+	case 99: return VK_FORMAT_BC7_SRGB_BLOCK;
+	default:
+		throw runtime_error( "unsupported DXGI format in DDS texture" );
+	}
+}
+
+VkFormat TextureFile::fromFourCC( uint32_t fourCC )
+{
+	if (fourCC == makeFourCC( "DXT1" )) return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+	if (fourCC == makeFourCC( "DXT3" )) return VK_FORMAT_BC2_UNORM_BLOCK;
+	if (fourCC == makeFourCC( "DXT5" )) return VK_FORMAT_BC3_UNORM_BLOCK;
+	if (fourCC == makeFourCC( "ATI1" ) || fourCC == makeFourCC( "BC4U" )) return VK_FORMAT_BC4_UNORM_BLOCK;
+	if (fourCC == makeFourCC( "ATI2" ) || fourCC == makeFourCC( "BC5U" )) return VK_FORMAT_BC5_UNORM_BLOCK;
+
+	throw runtime_error( "unsupported FourCC in DDS texture" );
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <string>
+
+#include "../asset/AssetData.hpp"
+
+using namespace std;
+
+namespace com::gelunox::vulcanUtils
+{
+	//size of a format's smallest addressable unit, a 4x4 block for BC and a single texel otherwise
+	struct FormatBlock
+	{
+		uint32_t bytes;
+		uint32_t size;
+	};
+
+	struct TextureLevel
+	{
+		uint32_t width;
+		uint32_t height;
+		size_t offset;
+		size_t size;
+	};
+
+	//a texture decoded into memory, level 0 is the largest
+	//KTX2 and DDS containers bring their own mip chain, only 2D images without array layers or faces, and no KTX2 supercompression
+	//other images are decoded by stb_image into a single rgba8 level, the rest of the chain is generated on upload
+	//decoding touches neither vulkan nor shared state, it is safe on any thread
+	//container levels point into the loaded file, a file that is a view into an AssetPack is never copied
+	class TextureFile
+	{
+	public:
+		VkFormat format = VK_FORMAT_UNDEFINED;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		vector<TextureLevel> levels;
+		AssetData data;
+		//set for a single rgba8 level that still needs its mip chain
+		bool generateMips = false;
+
+		//picks the container by its magic number and falls back to stb_image, throws when neither can read it
+		static TextureFile load( const string& path );
+		//name is only used in errors
+		static TextureFile load( AssetData file, const string& name );
+		static TextureFile fromRgba8( uint32_t width, uint32_t height, const uint8_t * pixels, bool generateMips );
+
+		static FormatBlock getFormatBlock( VkFormat format );
+		static bool isBlockCompressed( VkFormat format );
+
+		const uint8_t * getLevelData( uint32_t level ) const { return reinterpret_cast<const uint8_t *>(data.data()) + levels[level].offset; }
+
+	private:
+		static TextureFile loadKtx2( AssetData file );
+		static TextureFile loadDds( AssetData file );
+		static TextureFile loadImage( const AssetData& file, const string& path );
+		static VkFormat fromDxgi( uint32_t dxgiFormat );
+		static VkFormat fromFourCC( uint32_t fourCC );
+
+		//fills levels for consecutive, tightly packed levels starting at offset of data
+		void addPackedLevels( uint32_t levelCount, size_t offset );
+	};
+}
@@ -0,0 +1,206 @@
+#include "TextureStreamer.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+#include "../builder/ImageViewBuilder.hpp"
+#include "../builder/SamplerBuilder.hpp"
+#include "../profiling/CpuProfiler.hpp"
+
+using namespace com::gelunox::vulcanUtils;
+using namespace std;
+
+TextureStreamer::TextureStreamer( VkDevice device, MemoryFactory& memFac, AssetLoader& assets, VkBool32 anisotropy, uint32_t threadCount, uint32_t uploadsPerPoll )
+	: device( device ), memFac( memFac ), assets( assets ), anisotropy( anisotropy ), uploadsPerPoll( max( uploadsPerPoll, 1u ) )
+{
+	//2x2 grey checker, one level, it is never minified far enough to need more
+	const uint8_t pixels[] =
+	{
+		160, 160, 160, 255,		96, 96, 96, 255,
+		96, 96, 96, 255,		160, 160, 160, 255
+	};
+
+	uint32_t mipLevels;
+	VkFormat format;
+	memFac.createTextureImage( TextureFile::fromRgba8( 2, 2, pixels, false ), placeholder.image, placeholder.memory, mipLevels, format );
+	createView( placeholder, mipLevels, format );
+
+	if (threadCount == 0)
+	{
+		threadCount = max( thread::hardware_concurrency(), 2u ) - 1;
+	}
+
+	for (uint32_t i = 0; i < threadCount; i++)
+	{
+		workers.emplace_back( &TextureStreamer::workerLoop, this );
+	}
+}
+
+TextureStreamer::~TextureStreamer()
+{
+	{
+		lock_guard<mutex> guard( queueLock );
+		stopping = true;
+	}
+	queueReady.notify_all();
+
+	for (thread& worker : workers)
+	{
+		worker.join();
+	}
+
+	for (Request * request : requests)
+	{
+		if (request->state.load( memory_order_relaxed ) == UPLOADING)
+		{
+			memFac.wait( request->upload );
+		}
+
+		destroyTexture( request->texture );
+		delete request;
+	}
+
+	destroyTexture( placeholder );
+}
+
+uint32_t TextureStreamer::request( const string& path )
+{
+	Request * request = new Request();
+	request->path = path;
+	request->state.store( QUEUED, memory_order_relaxed );
+
+	requests.push_back( request );
+	pending.push_back( request );
+
+	{
+		lock_guard<mutex> guard( queueLock );
+		queue.push_back( request );
+	}
+	queueReady.notify_one();
+
+	return static_cast<uint32_t>(requests.size() - 1);
+}
+
+//no locks, a request's state is the only thing shared with the workers
+void TextureStreamer::poll()
+{
+	CpuScope scope( "TextureStreamer::poll" );
+
+	uint32_t uploads = 0;
+
+	for (size_t i = 0; i < pending.size(); )
+	{
+		Request * request = pending[i];
+
+		//acquire pairs with the worker's release, file and error are complete once the state says so
+		RequestState state = request->state.load( memory_order_acquire );
+
+		if (state == DECODED && uploads < uploadsPerPoll)
+		{
+			//the upload goes out on its own, the frame doesn't wait for it
+			memFac.beginBatch();
+
+			try
+			{
+				memFac.createTextureImage( request->file, request->texture.image, request->texture.memory, request->mipLevels, request->format );
+				request->state.store( UPLOADING, memory_order_relaxed );
+			}
+			catch (const exception& e)
+			{
+				//a format the device can't sample is only found out here, nothing was recorded yet
+				request->error = e.what();
+				request->state.store( FAILED, memory_order_relaxed );
+			}
+
+			request->upload = memFac.submitBatch();
+			request->file = TextureFile();
+			uploads++;
+		}
+		else if (state == UPLOADING && memFac.isComplete( request->upload ))
+		{
+			createView( request->texture, request->mipLevels, request->format );
+
+			request->state.store( RESIDENT, memory_order_relaxed );
+			version++;
+
+			pending.erase( pending.begin() + i );
+			continue;
+		}
+		else if (state == FAILED)
+		{
+			//keeps the placeholder for good
+			cerr << "texture " << request->path << " failed to load: " << request->error << endl;
+
+			pending.erase( pending.begin() + i );
+			continue;
+		}
+
+		i++;
+	}
+}
+
+TextureBinding TextureStreamer::getBinding( uint32_t handle )
+{
+	const Texture& texture = isResident( handle ) ? requests[handle]->texture : placeholder;
+
+	return { texture.view, texture.sampler };
+}
+
+void TextureStreamer::workerLoop()
+{
+	while (true)
+	{
+		Request * request;
+		{
+			unique_lock<mutex> guard( queueLock );
+			queueReady.wait( guard, [this] { return stopping || !queue.empty(); } );
+
+			if (stopping)
+			{
+				return;
+			}
+
+			request = queue.front();
+			queue.pop_front();
+		}
+
+		CpuScope scope( "TextureStreamer::decode" );
+
+		try
+		{
+			request->file = TextureFile::load( assets.load( request->path ), request->path );
+			request->state.store( DECODED, memory_order_release );
+		}
+		catch (const exception& e)
+		{
+			request->error = e.what();
+			request->state.store( FAILED, memory_order_release );
+		}
+	}
+}
+
+//the view and sampler don't need the image's contents, but nothing samples them before the upload completes
+void TextureStreamer::createView( Texture& texture, uint32_t mipLevels, VkFormat format )
+{
+	texture.view = ImageViewBuilder( device )
+		.setFormat( format )
+		.setImage( texture.image )
+		.setMipLevels( mipLevels )
+		.build();
+	texture.sampler = SamplerBuilder( device )
+		.setAnisotropy( anisotropy, 16.0f )
+		.setMipLevels( mipLevels )
+		.build();
+}
+
+void TextureStreamer::destroyTexture( Texture& texture )
+{
+	if (texture.image == VK_NULL_HANDLE)
+	{
+		return;
+	}
+
+	vkDestroySampler( device, texture.sampler, nullptr );
+	vkDestroyImageView( device, texture.view, nullptr );
+	memFac.destroyImage( texture.image, texture.memory );
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <deque>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#include "TextureFile.hpp"
+#include "../builder/MemoryFactory.hpp"
+#include "../asset/AssetLoader.hpp"
+
+using namespace std;
+
+namespace com::gelunox::vulcanUtils
+{
+	//what a descriptor needs to sample a texture
+	struct TextureBinding
+	{
+		VkImageView view;
+		VkSampler sampler;
+	};
+
+	//loads textures in the background, files are decoded on worker threads and uploaded through the MemoryFactory
+	//a requested texture samples a placeholder until its upload has finished on the gpu
+	//everything but the decoding happens on the render thread, in request and poll
+	class TextureStreamer
+	{
+	private:
+		enum RequestState
+		{
+			QUEUED,
+			DECODED,	//file is filled in, the render thread owns the request again
+			FAILED,		//error is filled in
+			UPLOADING,
+			RESIDENT
+		};
+
+		struct Texture
+		{
+			VkImage image = VK_NULL_HANDLE;
+			Allocation memory;
+			VkImageView view = VK_NULL_HANDLE;
+			VkSampler sampler = VK_NULL_HANDLE;
+		};
+
+		struct Request
+		{
+			string path;
+			//the only field both sides touch, a worker publishes file or error with a release store
+			atomic<RequestState> state;
+			TextureFile file;
+			string error;
+
+			UploadTicket upload;
+			uint32_t mipLevels;
+			VkFormat format;
+			Texture texture;
+		};
+
+		VkDevice device;
+		MemoryFactory& memFac;
+		AssetLoader& assets;
+		VkBool32 anisotropy;
+
+		Texture placeholder;
+		//indexed by the handles request returns, requests are never removed
+		vector<Request *> requests;
+		//not yet resident or failed, poll only looks at these
+		vector<Request *> pending;
+		//bumped whenever a texture became resident, descriptors written with an older version are stale
+		uint64_t version = 0;
+
+		//the only locked part, taken by request and the workers but never by poll
+		vector<thread> workers;
+		mutex queueLock;
+		condition_variable queueReady;
+		deque<Request *> queue;
+		bool stopping = false;
+
+		//decoded textures uploaded per poll, spreads the staging traffic of a scene load over several frames
+		const uint32_t uploadsPerPoll;
+
+	public:
+		//the placeholder is uploaded in the MemoryFactory's open batch, or waited for when there is none
+		//threadCount 0 keeps a hardware thread free for the render thread
+		TextureStreamer( VkDevice device, MemoryFactory& memFac, AssetLoader& assets, VkBool32 anisotropy, uint32_t threadCount = 0, uint32_t uploadsPerPoll = 2 );
+		//the device has to be idle, uploads still in flight are waited for
+		~TextureStreamer();
+
+		//returns right away, the handle binds the placeholder until the texture is resident
+		uint32_t request( const string& path );
+		//call once per frame, starts the uploads of decoded files and finishes those the gpu has completed
+		void poll();
+
+		bool isResident( uint32_t handle ) { return requests[handle]->state.load( memory_order_relaxed ) == RESIDENT; }
+		TextureBinding getBinding( uint32_t handle );
+		uint64_t getVersion() { return version; }
+		//requests that are neither resident nor failed
+		uint32_t getPendingCount() { return static_cast<uint32_t>(pending.size()); }
+
+	private:
+		void workerLoop();
+		void createView( Texture& texture, uint32_t mipLevels, VkFormat format );
+		void destroyTexture( Texture& texture );
+	};
+}
@@ -0,0 +1,322 @@
+#include "Json.hpp"
+
+#include <stdexcept>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+
+using namespace com::gelunox::vulcanUtils;
+using namespace std;
+
+static const JsonValue NULL_VALUE;
+
+//recursive descent over the raw bytes, nesting depth is bounded by the document
+class JsonValue::Parser
+{
+private:
+	const char * data;
+	size_t size;
+	size_t pos = 0;
+
+public:
+	Parser( const char * data, size_t size ) : data( data ), size( size ) {}
+
+	JsonValue parseDocument()
+	{
+		JsonValue value = parseValue();
+		skipWhitespace();
+
+		if (pos != size)
+		{
+			fail( "trailing characters" );
+		}
+		return value;
+	}
+
+private:
+	[[noreturn]] void fail( const char * what )
+	{
+		throw runtime_error( string( "malformed json at byte " ) + to_string( pos ) + ": " + what );
+	}
+
+	void skipWhitespace()
+	{
+		while (pos < size && (data[pos] == ' ' || data[pos] == '\t' || data[pos] == '\n' || data[pos] == '\r'))
+		{
+			pos++;
+		}
+	}
+
+	char peek()
+	{
+		skipWhitespace();
+		if (pos >= size)
+		{
+			fail( "unexpected end" );
+		}
+		return data[pos];
+	}
+
+	void expect( char c )
+	{
+		if (peek() != c)
+		{
+			fail( "unexpected character" );
+		}
+		pos++;
+	}
+
+	bool consume( const char * word )
+	{
+		size_t length = strlen( word );
+
+		if (size - pos >= length && memcmp( data + pos, word, length ) == 0)
+		{
+			pos += length;
+			return true;
+		}
+		return false;
+	}
+
+	JsonValue parseValue()
+	{
+		JsonValue value;
+		char c = peek();
+
+		if (c == '{')
+		{
+			value.type = OBJECT;
+			pos++;
+
+			if (peek() == '}')
+			{
+				pos++;
+				return value;
+			}
+
+			while (true)
+			{
+				string key = parseString();
+				expect( ':' );
+				value.members.emplace_back( move( key ), parseValue() );
+
+				if (peek() != ',')
+				{
+					break;
+				}
+				pos++;
+			}
+
+			expect( '}' );
+		}
+		else if (c == '[')
+		{
+			value.type = ARRAY;
+			pos++;
+
+			if (peek() == ']')
+			{
+				pos++;
+				return value;
+			}
+
+			while (true)
+			{
+				value.elements.push_back( parseValue() );
+
+				if (peek() != ',')
+				{
+					break;
+				}
+				pos++;
+			}
+
+			expect( ']' );
+		}
+		else if (c == '"')
+		{
+			value.type = STRING;
+			value.text = parseString();
+		}
+		else if (consume( "true" ))
+		{
+			value.type = BOOLEAN;
+			value.boolean = true;
+		}
+		else if (consume( "false" ))
+		{
+			value.type = BOOLEAN;
+		}
+		else if (consume( "null" ))
+		{
+			value.type = NUL;
+		}
+		else
+		{
+			value.type = NUMBER;
+			value.number = parseNumber();
+		}
+
+		return value;
+	}
+
+	double parseNumber()
+	{
+		size_t start = pos;
+
+		while (pos < size && (isdigit( static_cast<unsigned char>(data[pos]) ) || strchr( "+-.eE", data[pos] ) != nullptr))
+		{
+			pos++;
+		}
+		if (start == pos)
+		{
+			fail( "expected a value" );
+		}
+
+		//strtod needs a terminator
+		string number( data + start, pos - start );
+		char * end;
+		double value = strtod( number.c_str(), &end );
+
+		if (*end != 0)
+		{
+			fail( "malformed number" );
+		}
+		return value;
+	}
+
+	string parseString()
+	{
+		expect( '"' );
+		string text;
+
+		while (true)
+		{
+			if (pos >= size)
+			{
+				fail( "unterminated string" );
+			}
+
+			char c = data[pos++];
+
+			if (c == '"')
+			{
+				return text;
+			}
+			if (c != '\\')
+			{
+				text += c;
+				continue;
+			}
+
+			if (pos >= size)
+			{
+				fail( "unterminated string" );
+			}
+
+			switch (data[pos++])
+			{
+			case '"': text += '"'; break;
+			case '\\': text += '\\'; break;
+			case '/': text += '/'; break;
+			case 'b': text += '\b'; break;
+			case 'f': text += '\f'; break;
+			case 'n': text += '\n'; break;
+			case 'r': text += '\r'; break;
+			case 't': text += '\t'; break;
+			case 'u': appendCodePoint( text ); break;
+			default: fail( "unknown escape" );
+			}
+		}
+	}
+
+	//utf-8 encoded, surrogate pairs included
+	void appendCodePoint( string& text )
+	{
+		uint32_t code = parseHex4();
+
+		if (code >= 0xD800 && code < 0xDC00 && consume( "\\u" ))
+		{
+			code = 0x10000 + ((code - 0xD800) << 10) + (parseHex4() - 0xDC00);
+		}
+
+		if (code < 0x80)
+		{
+			text += static_cast<char>(code);
+		}
+		else if (code < 0x800)
+		{
+			text += static_cast<char>(0xC0 | code >> 6);
+			text += static_cast<char>(0x80 | (code & 0x3F));
+		}
+		else if (code < 0x10000)
+		{
+			text += static_cast<char>(0xE0 | code >> 12);
+			text += static_cast<char>(0x80 | (code >> 6 & 0x3F));
+			text += static_cast<char>(0x80 | (code & 0x3F));
+		}
+		else
+		{
+			text += static_cast<char>(0xF0 | code >> 18);
+			text += static_cast<char>(0x80 | (code >> 12 & 0x3F));
+			text += static_cast<char>(0x80 | (code >> 6 & 0x3F));
+			text += static_cast<char>(0x80 | (code & 0x3F));
+		}
+	}
+
+	uint32_t parseHex4()
+	{
+		if (size - pos < 4)
+		{
+			fail( "unterminated escape" );
+		}
+
+		uint32_t code = 0;
+		for (int i = 0; i < 4; i++)
+		{
+			char c = data[pos++];
+			code <<= 4;
+
+			if (c >= '0' && c <= '9') code |= c - '0';
+			else if (c >= 'a' && c <= 'f') code |= c - 'a' + 10;
+			else if (c >= 'A' && c <= 'F') code |= c - 'A' + 10;
+			else fail( "malformed escape" );
+		}
+		return code;
+	}
+};
+
+JsonValue JsonValue::parse( const char * data, size_t size )
+{
+	return Parser( data, size ).parseDocument();
+}
+
+bool JsonValue::has( const string& key ) const
+{
+	return !(*this)[key].isNull();
+}
+
+const JsonValue& JsonValue::operator[]( const string& key ) const
+{
+	for (const pair<string, JsonValue>& member : members)
+	{
+		if (member.first == key)
+		{
+			return member.second;
+		}
+	}
+	return NULL_VALUE;
+}
+
+const JsonValue& JsonValue::operator[]( size_t index ) const
+{
+	if (type == ARRAY && index < elements.size())
+	{
+		return elements[index];
+	}
+	if (type == OBJECT && index < members.size())
+	{
+		return members[index].second;
+	}
+	return NULL_VALUE;
+}
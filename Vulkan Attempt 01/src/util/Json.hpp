@@ -0,0 +1,57 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+using namespace std;
+
+namespace com::gelunox::vulcanUtils
+{
+	//just enough json for glTF, a parsed document as a tree of values
+	//lookups of missing keys or indices return a shared null value instead of throwing, so optional fields read naturally
+	class JsonValue
+	{
+	public:
+		enum Type
+		{
+			NUL,
+			BOOLEAN,
+			NUMBER,
+			STRING,
+			ARRAY,
+			OBJECT
+		};
+
+	private:
+		Type type = NUL;
+		bool boolean = false;
+		double number = 0;
+		string text;
+		vector<JsonValue> elements;
+		//in document order, glTF objects are small enough for a linear search
+		vector<pair<string, JsonValue>> members;
+
+	public:
+		//throws on malformed input
+		static JsonValue parse( const char * data, size_t size );
+
+		Type getType() const { return type; }
+		bool isNull() const { return type == NUL; }
+		bool has( const string& key ) const;
+
+		const JsonValue& operator[]( const string& key ) const;
+		const JsonValue& operator[]( size_t index ) const;
+		size_t size() const { return type == ARRAY ? elements.size() : members.size(); }
+
+		//the fallback is returned when the value has another type, which includes a missing one
+		double asNumber( double fallback = 0 ) const { return type == NUMBER ? number : fallback; }
+		uint32_t asUint( uint32_t fallback = 0 ) const { return type == NUMBER ? static_cast<uint32_t>(number) : fallback; }
+		bool asBool( bool fallback = false ) const { return type == BOOLEAN ? boolean : fallback; }
+		const string& asString() const { return text; }
+
+	private:
+		class Parser;
+	};
+}
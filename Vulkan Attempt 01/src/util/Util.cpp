@@ -1,5 +1,7 @@
 #include "Util.hpp"
 
+#include <limits>
+
 using namespace com::gelunox::vulcanUtils;
 
 vector<char> Util::readFile( const string& filename )
@@ -8,10 +10,11 @@ vector<char> Util::readFile( const string& filename )
 
 	if (!file.is_open())
 	{
-		throw runtime_error( "can't open file" );
+		throw runtime_error( "can't open file " + filename );
 	}
 
-	unsigned int fileSize = file.tellg();
+	//tellg is 64 bit, files over 4 GB keep their size
+	size_t fileSize = static_cast<size_t>(file.tellg());
 	vector<char> buff( fileSize );
 
 	file.seekg( 0 );
@@ -117,4 +120,43 @@ VkPresentModeKHR Util::getPresentMode( VkPhysicalDevice physicalDevice, VkSurfac
 	}
 
 	return mode;
-}
\ No newline at end of file
+}
+
+uint32_t Util::getMipLevelCount( uint32_t width, uint32_t height )
+{
+	uint32_t levels = 1;
+	for (uint32_t size = max( width, height ); size > 1; size /= 2)
+	{
+		levels++;
+	}
+
+	return levels;
+}
+
+void Util::downsampleRgba8( const uint8_t * src, uint32_t width, uint32_t height, uint8_t * dst )
+{
+	uint32_t dstWidth = max( width / 2, 1u );
+	uint32_t dstHeight = max( height / 2, 1u );
+	size_t srcPitch = static_cast<size_t>(width) * 4;
+
+	for (uint32_t y = 0; y < dstHeight; y++)
+	{
+		//a 1 texel high or wide source samples its only row or column twice
+		const uint8_t * row0 = src + min( y * 2, height - 1 ) * srcPitch;
+		const uint8_t * row1 = src + min( y * 2 + 1, height - 1 ) * srcPitch;
+		uint8_t * out = dst + static_cast<size_t>(y) * dstWidth * 4;
+
+		for (uint32_t x = 0; x < dstWidth; x++)
+		{
+			size_t left = min( x * 2, width - 1 ) * 4;
+			size_t right = min( x * 2 + 1, width - 1 ) * 4;
+
+			//no dependency between the channels or texels, compilers turn this into simd
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				uint32_t sum = row0[left + c] + row0[right + c] + row1[left + c] + row1[right + c];
+				out[x * 4 + c] = static_cast<uint8_t>((sum + 2) / 4);
+			}
+		}
+	}
+}
@@ -11,6 +11,7 @@ using namespace std;
 
 namespace com::gelunox::vulcanUtils::Util
 {
+	//a copy of the whole file, assets should go through an AssetLoader so they come from the pack when there is one
 	vector<char> readFile( const string& filename );
 
 	uint32_t findMemoryType( VkPhysicalDevice& device, uint32_t typeFilter, VkMemoryPropertyFlags properties );
@@ -18,4 +19,16 @@ namespace com::gelunox::vulcanUtils::Util
 	VkExtent2D getExtent( uint32_t width, uint32_t height, VkSurfaceCapabilitiesKHR & capabilities );
 	VkSurfaceFormatKHR getSurfaceFormat( VkPhysicalDevice physicalDevice, VkSurfaceKHR surface );
 	VkPresentModeKHR getPresentMode( VkPhysicalDevice physicalDevice, VkSurfaceKHR surface );
+
+	//rounds value up to the next multiple of alignment, which doesn't have to be a power of two
+	inline VkDeviceSize alignUp( VkDeviceSize value, VkDeviceSize alignment )
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	//levels of a full chain down to 1x1
+	uint32_t getMipLevelCount( uint32_t width, uint32_t height );
+	//halves an rgba8 image with a 2x2 box filter, the last row or column of an odd size is skipped
+	//dst holds max( width / 2, 1 ) * max( height / 2, 1 ) texels
+	void downsampleRgba8( const uint8_t * src, uint32_t width, uint32_t height, uint8_t * dst );
 }
\ No newline at end of file